@@ -0,0 +1,153 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    Benchmark.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef BENCHMARK_HPP_
+#define BENCHMARK_HPP_
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/function.hpp>
+#include <opencv2/core/core.hpp>
+
+/*! @class BenchmarkResult
+ *  @brief the timings of a benchmark, in seconds per iteration
+ */
+struct BenchmarkResult {
+	std::string name;
+	unsigned int iterations;
+	double mean, median, min, max, stddev;
+};
+
+/*! @class BenchmarkSuite
+ *  @brief runs a set of named benchmarks and reports their timings
+ *
+ * Each benchmark is a function timed one call at a time. It is called
+ * once to warm up, then repeatedly until both a minimum number of calls
+ * and a minimum time have been reached. Setup belongs outside of the
+ * function, in the state it is bound to. The median is the most stable
+ * statistic to compare between runs
+ */
+class BenchmarkSuite {
+private:
+	//! the benchmarks, in the order they were added
+	std::vector<std::pair<std::string, boost::function<void (void)> > > benchmarks_;
+	//! the minimum time to run each benchmark for, in seconds
+	double mintime_;
+	//! the minimum and maximum number of timed calls
+	unsigned int minruns_, maxruns_;
+public:
+	BenchmarkSuite(double mintime = 1.0, unsigned int minruns = 5, unsigned int maxruns = 1000) :
+		mintime_(mintime), minruns_(minruns), maxruns_(maxruns) {}
+	virtual ~BenchmarkSuite() {}
+
+	//! add a benchmark
+	void add(const std::string& name, const boost::function<void (void)>& benchmark) {
+		benchmarks_.push_back(std::make_pair(name, benchmark));
+	}
+
+	/*! @brief run the benchmarks
+	 *
+	 * @param filter only benchmarks whose name contains the filter are run
+	 * @param results the results of the benchmarks run
+	 */
+	void run(const std::string& filter, std::vector<BenchmarkResult>& results) const {
+		results.clear();
+		for (unsigned int b = 0; b < benchmarks_.size(); ++b) {
+			if (benchmarks_[b].first.find(filter) == std::string::npos) continue;
+			const boost::function<void (void)>& benchmark = benchmarks_[b].second;
+			benchmark();
+
+			std::vector<double> times;
+			double total = 0;
+			while (times.size() < maxruns_ && (times.size() < minruns_ || total < mintime_)) {
+				const double t = (double)cv::getTickCount();
+				benchmark();
+				times.push_back(((double)cv::getTickCount() - t)/cv::getTickFrequency());
+				total += times.back();
+			}
+
+			BenchmarkResult result;
+			result.name = benchmarks_[b].first;
+			result.iterations = times.size();
+			result.mean = total / times.size();
+			double var = 0;
+			for (unsigned int n = 0; n < times.size(); ++n) var += (times[n] - result.mean) * (times[n] - result.mean);
+			result.stddev = std::sqrt(var / times.size());
+			std::sort(times.begin(), times.end());
+			result.min = times.front();
+			result.max = times.back();
+			result.median = (times.size() % 2) ? times[times.size()/2] : (times[times.size()/2-1] + times[times.size()/2]) / 2;
+			results.push_back(result);
+		}
+	}
+
+	//! write results as a table
+	static void table(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+		for (unsigned int n = 0; n < results.size(); ++n) {
+			const BenchmarkResult& r = results[n];
+			out << r.name << std::string(r.name.size() < 40 ? 40 - r.name.size() : 1, ' ')
+				<< "median " << r.median*1e3 << " ms, mean " << r.mean*1e3 << " ms, stddev " << r.stddev*1e3
+				<< " ms (" << r.iterations << " iterations)" << std::endl;
+		}
+	}
+
+	/*! @brief write results as JSON
+	 *
+	 * @param out the stream to write to
+	 * @param results the results
+	 * @param context a JSON object describing the run (threads, seed, ...), written as is
+	 */
+	static void json(std::ostream& out, const std::vector<BenchmarkResult>& results, const std::string& context) {
+		out << "{\"context\":" << context << ",\"benchmarks\":[";
+		for (unsigned int n = 0; n < results.size(); ++n) {
+			const BenchmarkResult& r = results[n];
+			out << (n ? "," : "") << "\n{\"name\":\"" << r.name << "\""
+				<< ",\"iterations\":" << r.iterations
+				<< ",\"median\":" << r.median
+				<< ",\"mean\":" << r.mean
+				<< ",\"min\":" << r.min
+				<< ",\"max\":" << r.max
+				<< ",\"stddev\":" << r.stddev << "}";
+		}
+		out << "\n]}" << std::endl;
+	}
+};
+
+#endif /* BENCHMARK_HPP_ */
@@ -0,0 +1,296 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    benchmarks.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <opencv2/core/core.hpp>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "Benchmark.hpp"
+#include "SyntheticModel.hpp"
+#include "CandidateSet.hpp"
+#include "DistanceTransform.hpp"
+#include "DynamicProgram.hpp"
+#include "HOGFeatures.hpp"
+#include "IncrementalDetector.hpp"
+#include "Math.hpp"
+#include "PartsBasedDetector.hpp"
+#include "SpatialConvolutionEngine.hpp"
+#include "nms.hpp"
+using namespace cv;
+using namespace std;
+
+//! the seed of every random input
+static const unsigned int SEED = 42;
+
+//! a random color image
+static Mat randomImage(int width, int height, unsigned int seed = SEED) {
+	Mat im(height, width, CV_8UC3);
+	RNG rng(seed);
+	rng.fill(im, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+	return im;
+}
+
+//! a random score map
+static Mat randomScores(int width, int height, unsigned int seed = SEED) {
+	Mat scores(height, width, DataType<float>::type);
+	RNG rng(seed);
+	rng.fill(scores, RNG::NORMAL, Scalar(0), Scalar(1));
+	return scores;
+}
+
+/*! @brief the inputs of the benchmarks of a model
+ *
+ * The feature pyramid and filter responses of a random image, and the
+ * dynamic program compiled from the model, computed once up front
+ */
+struct ModelFixture {
+	boost::shared_ptr<SyntheticModel> model;
+	boost::shared_ptr<HOGFeatures<float> > features;
+	boost::shared_ptr<SpatialConvolutionEngine> engine;
+	boost::shared_ptr<IConvolutionWorkspace> workspace;
+	boost::shared_ptr<DynamicProgram<float> > dp;
+	boost::shared_ptr<PartsBasedDetector<float> > detector;
+	Parts parts;
+	Mat image;
+	vectorMat pyramid;
+	vectorf scales;
+	vector2DMat pdf;
+	vector4DMat Ix, Iy, Ik;
+	vector2DMat rootv, rooti;
+
+	ModelFixture(const SyntheticModel& synthetic, const Mat& im) : model(new SyntheticModel(synthetic)), image(im) {
+		features.reset(new HOGFeatures<float>(model->binsize(), model->nscales(), model->flen(), model->norient()));
+		engine.reset(new SpatialConvolutionEngine(DataType<float>::type, model->flen()));
+		engine->setFilters(model->filters());
+		workspace.reset(engine->createWorkspace());
+		parts = Parts(model->filters(), model->filtersi(), model->def(), model->defi(), model->bias(), model->biasi(),
+				model->anchors(), model->biasid(), model->filterid(), model->defid(), model->parentid());
+		dp.reset(new DynamicProgram<float>);
+		dp->setThreshold(model->thresh());
+		dp->setTopK(100);
+		dp->compile(parts);
+		detector.reset(new PartsBasedDetector<float>);
+		detector->distributeModel(*model);
+		detector->setTopK(100);
+
+		features->pyramid(image, pyramid, scales);
+		engine->pdf(pyramid, pdf, vector2Di(), *workspace);
+		dp->min(pdf, Ix, Iy, Ik, rootv, rooti);
+		dp->selectTopK(rootv);
+	}
+
+	void hogPyramid(void) {
+		vectorMat p;
+		vectorf s;
+		features->pyramid(image, p, s);
+	}
+	void convolve(void) {
+		vector2DMat responses;
+		engine->pdf(pyramid, responses, vector2Di(), *workspace);
+	}
+	void min(void) {
+		vector2DMat scores(pdf);
+		vector4DMat x, y, k;
+		vector2DMat v, i;
+		dp->min(scores, x, y, k, v, i);
+	}
+	void argmin(void) {
+		CandidateSet candidates;
+		dp->argmin(rootv, rooti, scales, Ix, Iy, Ik, candidates);
+	}
+	void detect(void) {
+		CandidateSet candidates;
+		detector->detect(image, candidates);
+	}
+};
+
+/*! @brief IncrementalDetector::detect() in the steady state of a static camera
+ *
+ * The frames alternate between two which differ in a single patch, so
+ * that each call recomputes only the tiles around the patch. Compare with
+ * the detect benchmark of the same model, which processes every frame in full
+ */
+struct IncrementalDetect {
+	boost::shared_ptr<PartsBasedDetector<float> > detector;
+	boost::shared_ptr<IncrementalDetector<float> > incremental;
+	Mat frames[2];
+	unsigned int next;
+	IncrementalDetect(SyntheticModel model, const Mat& im, int patch) : detector(new PartsBasedDetector<float>), next(0) {
+		detector->distributeModel(model);
+		detector->setTopK(100);
+		incremental.reset(new IncrementalDetector<float>(*detector));
+		frames[0] = im;
+		frames[1] = im.clone();
+		Mat changed = frames[1](Rect((im.cols-patch)/2, (im.rows-patch)/2, patch, patch));
+		RNG rng(SEED+1);
+		rng.fill(changed, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+		CandidateSet candidates;
+		incremental->detect(frames[0], candidates);
+	}
+	void operator()(void) {
+		next = 1 - next;
+		CandidateSet candidates;
+		incremental->detect(frames[next], candidates);
+	}
+};
+
+//! HOGFeatures::features() of a single image
+struct HogFeatures {
+	boost::shared_ptr<HOGFeatures<float> > features;
+	Mat image;
+	HogFeatures(int width, int height) : features(new HOGFeatures<float>(4, 5, 32, 18)), image(randomImage(width, height)) {}
+	void operator()(void) {
+		Mat feature;
+		features->features(image, feature);
+	}
+};
+
+//! DistanceTransform::compute() of a single score map
+struct DistanceTransformCompute {
+	DistanceTransform<float> dt;
+	Mat_<float> scores;
+	DistanceTransformCompute(int width, int height) : scores(randomScores(width, height)) {}
+	void operator()(void) {
+		Mat_<float> out;
+		Mat_<int> Ix, Iy;
+		dt.compute(scores, Quadratic(-0.01, 0), Quadratic(-0.01, 0), Point(2, 1), out, Ix, Iy);
+	}
+};
+
+//! Math::reduceMax() over the mixtures of a part
+struct ReduceMax {
+	vectorMat scores;
+	ReduceMax(int width, int height, int nmixtures) {
+		for (int m = 0; m < nmixtures; ++m) scores.push_back(randomScores(width, height, SEED+m));
+	}
+	void operator()(void) {
+		Mat maxv, maxi;
+		Math::reduceMax<float>(scores, maxv, maxi);
+	}
+};
+
+//! nonMaximaSuppression() of a set of boxes
+struct BoxSuppression {
+	vector<Rect> boxes;
+	vectorf scores;
+	BoxSuppression(unsigned int nboxes) {
+		RNG rng(SEED);
+		for (unsigned int n = 0; n < nboxes; ++n) {
+			const int size = rng.uniform(20, 200);
+			boxes.push_back(Rect(rng.uniform(0, 640), rng.uniform(0, 480), size, size));
+			scores.push_back(rng.uniform(-1.0f, 1.0f));
+		}
+	}
+	void operator()(void) {
+		vector<unsigned int> keep;
+		nonMaximaSuppression(boxes, scores, 0.3f, keep);
+	}
+};
+
+static void usage(void) {
+	printf("Usage: PartsBasedDetector_benchmarks [--json results.json] [--filter substring] [--min-time seconds]\n");
+}
+
+int main(int argc, char** argv) {
+
+	// parse the arguments
+	string jsonfile, filter;
+	double mintime = 1.0;
+	for (int n = 1; n < argc; ++n) {
+		if (strcmp(argv[n], "--json") == 0 && n+1 < argc) jsonfile = argv[++n];
+		else if (strcmp(argv[n], "--filter") == 0 && n+1 < argc) filter = argv[++n];
+		else if (strcmp(argv[n], "--min-time") == 0 && n+1 < argc) mintime = atof(argv[++n]);
+		else { usage(); return -1; }
+	}
+
+	BenchmarkSuite suite(mintime);
+
+	// features
+	const int widths[]  = {320, 640, 1280};
+	const int heights[] = {240, 480, 720};
+	for (unsigned int n = 0; n < 3; ++n) {
+		ostringstream name;
+		name << "hog/features/" << widths[n] << "x" << heights[n];
+		suite.add(name.str(), HogFeatures(widths[n], heights[n]));
+	}
+
+	// distance transforms, reductions and suppression
+	suite.add("dt/compute/160x120", DistanceTransformCompute(160, 120));
+	suite.add("dt/compute/320x240", DistanceTransformCompute(320, 240));
+	suite.add("math/reduceMax/6x160x120", ReduceMax(160, 120, 6));
+	suite.add("nms/boxes/2000", BoxSuppression(2000));
+
+	// the stages of each model, and end to end
+	const Mat image = randomImage(640, 480);
+	boost::shared_ptr<ModelFixture> face(new ModelFixture(SyntheticModel::face(SEED), image));
+	boost::shared_ptr<ModelFixture> person(new ModelFixture(SyntheticModel::person(SEED), image));
+	ModelFixture* fixtures[] = {face.get(), person.get()};
+	const char* names[] = {"face", "person"};
+	for (unsigned int n = 0; n < 2; ++n) {
+		const string model = names[n];
+		suite.add("hog/pyramid/" + model + "/640x480", boost::bind(&ModelFixture::hogPyramid, fixtures[n]));
+		suite.add("convolution/spatial/" + model + "/640x480", boost::bind(&ModelFixture::convolve, fixtures[n]));
+		suite.add("dp/min/" + model + "/640x480", boost::bind(&ModelFixture::min, fixtures[n]));
+		suite.add("dp/argmin/" + model + "/640x480", boost::bind(&ModelFixture::argmin, fixtures[n]));
+		suite.add("detect/" + model + "/640x480", boost::bind(&ModelFixture::detect, fixtures[n]));
+	}
+	suite.add("detect/incremental/person/640x480/32x32", IncrementalDetect(*person->model, image, 32));
+
+	// run, then report
+	vector<BenchmarkResult> results;
+	suite.run(filter, results);
+	BenchmarkSuite::table(cout, results);
+	if (!jsonfile.empty()) {
+		int threads = 1;
+		#ifdef _OPENMP
+		threads = omp_get_max_threads();
+		#endif
+		ostringstream context;
+		context << "{\"threads\":" << threads << ",\"seed\":" << SEED << ",\"min_time\":" << mintime << "}";
+		ofstream file(jsonfile.c_str());
+		BenchmarkSuite::json(file, results, context.str());
+	}
+	return 0;
+}
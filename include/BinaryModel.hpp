@@ -0,0 +1,85 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    BinaryModel.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef BINARYMODEL_HPP_
+#define BINARYMODEL_HPP_
+#include <string>
+#include <opencv2/core/core.hpp>
+#include "Model.hpp"
+
+/*! @class BinaryModel
+ *  @brief Model with a versioned binary (de-)serialization, loaded by memory mapping
+ *
+ * The filters are stored in the precision of the detector which will use
+ * them, each aligned to a cache line, so that deserialize() maps the file
+ * and the filters refer straight into the mapping. Nothing is
+ * parsed or converted, and processes loading the same model share its
+ * pages. The index tables are stored as flat arrays with offsets. Models
+ * written by the ModelCompiler also carry the filters in the layout of
+ * the convolution engine (see IConvolutionEngine::compileFilters()).
+ *
+ * The mapping is private and copy-on-write: the filters may be modified
+ * in place (for example converted by CascadeCalibration), which copies the
+ * pages written to and leaves the file unchanged. The mapping is held by
+ * storage(), which PartsBasedDetector::distributeModel() keeps for the
+ * life of the detector.
+ * Other models can be converted by assignment:
+ *
+ * @code
+ * FileStorageModel xml;
+ * xml.deserialize("models/Person.xml");
+ * BinaryModel binary(CV_32F);
+ * static_cast<Model&>(binary) = xml;
+ * binary.serialize("models/Person.pbm");
+ * @endcode
+ */
+class BinaryModel: public Model {
+private:
+	//! the precision of the filters when serialized
+	int depth_;
+public:
+	//! the version of the format written by serialize()
+	static const unsigned int VERSION = 2;
+	explicit BinaryModel(int depth = CV_32F) : depth_(depth) {}
+	virtual ~BinaryModel() {}
+	int depth(void) const { return depth_; }
+	// persistence methods
+	bool deserialize(const std::string& filename);
+	bool serialize(const std::string& filename) const;
+};
+
+#endif /* BINARYMODEL_HPP_ */
@@ -0,0 +1,154 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    BoundedQueue.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef BOUNDEDQUEUE_HPP_
+#define BOUNDEDQUEUE_HPP_
+#include <deque>
+#include <opencv2/core/core.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+//! what to do with a new element when a queue is full
+enum DropPolicy {
+	//! wait for space
+	DROP_NONE,
+	//! discard the new element
+	DROP_NEWEST,
+	//! discard the oldest element in the queue
+	DROP_OLDEST
+};
+
+/*! @class BoundedQueue
+ *  @brief a blocking queue with a fixed capacity, shared between threads
+ *
+ * Once closed, push() fails and pop() fails as soon as the queue is empty,
+ * until the queue is opened again with open()
+ */
+template<typename E>
+class BoundedQueue {
+private:
+	std::deque<E> queue_;
+	unsigned int capacity_;
+	bool closed_;
+	boost::mutex mutex_;
+	boost::condition_variable notempty_;
+	boost::condition_variable notfull_;
+public:
+	/*! @brief create an empty, open queue
+	 *
+	 * @param capacity the number of elements the queue may hold, at least 1
+	 */
+	BoundedQueue(unsigned int capacity) : capacity_(capacity), closed_(false) {
+		if (capacity < 1) CV_Error(CV_StsBadArg, "a queue must hold at least one element");
+	}
+
+	/*! @brief add an element to the back of the queue
+	 *
+	 * @param e the element to add
+	 * @param policy what to do if the queue is full
+	 * @param dropped set to the element discarded, if any
+	 * @return the number of elements discarded (0 or 1). push() on a closed
+	 * queue discards e
+	 */
+	unsigned int push(const E& e, DropPolicy policy, E& dropped) {
+		boost::unique_lock<boost::mutex> lock(mutex_);
+		if (policy == DROP_NONE) {
+			while (!closed_ && queue_.size() >= capacity_) notfull_.wait(lock);
+		}
+		if (closed_) { dropped = e; return 1; }
+		unsigned int ndropped = 0;
+		if (queue_.size() >= capacity_) {
+			if (policy == DROP_NEWEST) { dropped = e; return 1; }
+			dropped = queue_.front();
+			queue_.pop_front();
+			ndropped = 1;
+		}
+		queue_.push_back(e);
+		notempty_.notify_one();
+		return ndropped;
+	}
+
+	/*! @brief remove an element from the front of the queue, waiting if it is empty
+	 *
+	 * @param e the element removed
+	 * @return false if the queue is closed and empty
+	 */
+	bool pop(E& e) {
+		boost::unique_lock<boost::mutex> lock(mutex_);
+		while (!closed_ && queue_.empty()) notempty_.wait(lock);
+		if (queue_.empty()) return false;
+		e = queue_.front();
+		queue_.pop_front();
+		notfull_.notify_one();
+		return true;
+	}
+
+	/*! @brief remove an element from the front of the queue, if there is one
+	 *
+	 * @param e the element removed
+	 * @return false if the queue is empty
+	 */
+	bool tryPop(E& e) {
+		boost::lock_guard<boost::mutex> lock(mutex_);
+		if (queue_.empty()) return false;
+		e = queue_.front();
+		queue_.pop_front();
+		notfull_.notify_one();
+		return true;
+	}
+
+	//! stop accepting elements, and wake all waiting threads
+	void close(void) {
+		boost::lock_guard<boost::mutex> lock(mutex_);
+		closed_ = true;
+		notempty_.notify_all();
+		notfull_.notify_all();
+	}
+
+	/*! @brief discard any elements and accept elements again after close()
+	 *
+	 * No thread may be waiting on the queue
+	 */
+	void open(void) {
+		boost::lock_guard<boost::mutex> lock(mutex_);
+		queue_.clear();
+		closed_ = false;
+	}
+};
+
+#endif /* BOUNDEDQUEUE_HPP_ */
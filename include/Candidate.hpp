@@ -45,6 +45,7 @@
 #include "types.hpp"
 #include "Rect3.hpp"
 #include "Math.hpp"
+#include "nms.hpp"
 
 /*! @class Candidate
  *  @brief detection candidate
@@ -77,7 +78,7 @@ public:
 	//! set the candidate component
 	void setComponent(int c) { component_ = c; }
 	//! get the candidate component
-	int component(void) { return component_; }
+	int component(void) const { return component_; }
 	//! rescale the parts
 	void resize(const float factor) {
 		for (unsigned int n = 0; n < parts_.size(); ++n) {
@@ -88,7 +89,7 @@ public:
 		}
 	}
 	//! descending comparison method for ordering objects of type Candidate
-	static bool descending(Candidate c1, Candidate c2) { return c1.score() > c2.score(); }
+	static bool descending(const Candidate& c1, const Candidate& c2) { return c1.score() > c2.score(); }
 
 	/*! @brief Sort the candidates from best to worst, in place
 	 *
@@ -303,6 +304,67 @@ public:
 		candidates.resize(keep);
 	}
 
+	/*! @brief suppress non-maximal candidates by their overlap with each other
+	 *
+	 * Keeps the candidates whose bounding boxes overlap each better candidate
+	 * by at most overlap, without painting them into an image. The candidates
+	 * need not be sorted, and are returned from best to worst
+	 *
+	 * @param candidates the vector of candidates
+	 * @param overlap the largest allowable overlap [0.0 1.0)
+	 * @param criterion the measure of overlap
+	 * @param K the maximum number of candidates to keep, or 0 to keep all
+	 * @see ::nonMaximaSuppression(const std::vector<cv::Rect>&, const std::vector<float>&, const float, std::vector<unsigned int>&, const OverlapCriterion, const unsigned int)
+	 */
+	static void nonMaximaSuppression(vectorCandidate& candidates, const float overlap, const OverlapCriterion criterion=OVERLAP_IOU, const unsigned int K=0) {
+
+		const unsigned int N = candidates.size();
+		std::vector<cv::Rect> boxes(N);
+		vectorf scores(N);
+		for (unsigned int n = 0; n < N; ++n) {
+			boxes[n]  = candidates[n].boundingBox();
+			scores[n] = candidates[n].score();
+		}
+		std::vector<unsigned int> keep;
+		::nonMaximaSuppression(boxes, scores, overlap, keep, criterion, K);
+
+		vectorCandidate kept(keep.size());
+		for (unsigned int n = 0; n < keep.size(); ++n) std::swap(kept[n], candidates[keep[n]]);
+		candidates.swap(kept);
+	}
+
+	/*! @brief rescore overlapping candidates rather than suppressing them
+	 *
+	 * The candidates are returned from best to worst rescored score
+	 *
+	 * @see ::softNonMaximaSuppression()
+	 * @param candidates the vector of candidates
+	 * @param method the decay function
+	 * @param overlap the IoU above which candidates are decayed (linear only)
+	 * @param sigma the width of the decay (gaussian only)
+	 * @param thresh the lowest rescored score to keep
+	 */
+	static void softNonMaximaSuppression(vectorCandidate& candidates, const SoftSuppression method=SOFT_GAUSSIAN,
+			const float overlap=0.3f, const float sigma=0.5f, const float thresh=-std::numeric_limits<float>::infinity()) {
+
+		const unsigned int N = candidates.size();
+		std::vector<cv::Rect> boxes(N);
+		vectorf scores(N);
+		for (unsigned int n = 0; n < N; ++n) {
+			boxes[n]  = candidates[n].boundingBox();
+			scores[n] = candidates[n].score();
+		}
+		std::vector<unsigned int> keep;
+		::softNonMaximaSuppression(boxes, scores, keep, method, overlap, sigma, thresh);
+
+		vectorCandidate kept(keep.size());
+		for (unsigned int n = 0; n < keep.size(); ++n) {
+			std::swap(kept[n], candidates[keep[n]]);
+			kept[n].setScore(scores[keep[n]]);
+		}
+		candidates.swap(kept);
+	}
+
 	/*! @brief return a masked representation of a set of candidates
 	 *
 	 * Given a vector of candidates which have already been non-maximally
@@ -0,0 +1,361 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    CandidateSet.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef CANDIDATESET_HPP_
+#define CANDIDATESET_HPP_
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "types.hpp"
+#include "Candidate.hpp"
+#include "nms.hpp"
+
+class CandidateSet;
+
+/*! @class CandidateView
+ *  @brief a read-only reference to a single candidate in a CandidateSet
+ *
+ * CandidateView offers the read accessors of Candidate without owning any
+ * storage, so it is cheap to create and copy. It is invalidated by any
+ * operation which reorders or grows the CandidateSet
+ */
+class CandidateView {
+private:
+	const CandidateSet* set_;
+	unsigned int idx_;
+public:
+	CandidateView(const CandidateSet& set, unsigned int idx) : set_(&set), idx_(idx) {}
+	//! the index of the candidate within its set
+	unsigned int index(void) const { return idx_; }
+	inline unsigned int nparts(void) const;
+	inline const cv::Rect& part(unsigned int p) const;
+	inline float confidence(unsigned int p) const;
+	inline float score(void) const;
+	inline int component(void) const;
+	inline int scale(void) const;
+	inline cv::Rect boundingBox(void) const;
+	inline Candidate candidate(void) const;
+};
+
+/*! @class CandidateSet
+ *  @brief a structure-of-arrays container of detection candidates
+ *
+ * Stores the same information as a vector of Candidate, but in a handful
+ * of contiguous arrays: the part bounding boxes and confidences of every
+ * candidate back to back, and the score, component and scale of each
+ * candidate. Growing, sorting and suppressing the set therefore costs
+ * a few large allocations rather than two per candidate.
+ *
+ * The root part of each candidate comes first, and its confidence is the
+ * candidate's score
+ */
+class CandidateSet {
+private:
+	//! the bounding boxes of the parts of every candidate
+	std::vector<cv::Rect> parts_;
+	//! the confidence of the parts of every candidate
+	vectorf confidence_;
+	//! the score of each candidate
+	vectorf score_;
+	//! the model component of each candidate
+	vectori component_;
+	//! the scale index of each candidate (-1 if unknown)
+	vectori scale_;
+	//! the index of the first part of each candidate, followed by parts_.size()
+	std::vector<unsigned int> offset_;
+
+	//! orders candidate indices by descending score
+	struct ScoreDescending {
+		const vectorf& score;
+		ScoreDescending(const vectorf& score) : score(score) {}
+		bool operator()(unsigned int i1, unsigned int i2) const { return score[i1] > score[i2]; }
+	};
+
+	/*! @brief keep the selected candidates only, in the given order
+	 *
+	 * @param select the indices of the candidates to keep
+	 */
+	void select(const std::vector<unsigned int>& select) {
+		CandidateSet selected;
+		unsigned int nparts = 0;
+		for (unsigned int n = 0; n < select.size(); ++n) nparts += this->nparts(select[n]);
+		selected.reserve(select.size(), nparts);
+		for (unsigned int n = 0; n < select.size(); ++n) {
+			const unsigned int i = select[n];
+			selected.parts_.insert(selected.parts_.end(), parts_.begin()+offset_[i], parts_.begin()+offset_[i+1]);
+			selected.confidence_.insert(selected.confidence_.end(), confidence_.begin()+offset_[i], confidence_.begin()+offset_[i+1]);
+			selected.score_.push_back(score_[i]);
+			selected.component_.push_back(component_[i]);
+			selected.scale_.push_back(scale_[i]);
+			selected.offset_.push_back(selected.parts_.size());
+		}
+		swap(selected);
+	}
+
+public:
+	CandidateSet() : offset_(1, 0) {}
+	//! construct from a vector of Candidate
+	explicit CandidateSet(const vectorCandidate& candidates) : offset_(1, 0) {
+		for (unsigned int n = 0; n < candidates.size(); ++n) push_back(candidates[n]);
+	}
+	virtual ~CandidateSet() {}
+
+	//! the number of candidates
+	unsigned int size(void) const { return score_.size(); }
+	//! is the set empty
+	bool empty(void) const { return score_.empty(); }
+	//! remove all candidates
+	void clear(void) {
+		parts_.clear(); confidence_.clear(); score_.clear(); component_.clear(); scale_.clear();
+		offset_.assign(1, 0);
+	}
+	//! reserve space for n candidates with nparts parts between them
+	void reserve(unsigned int n, unsigned int nparts) {
+		parts_.reserve(nparts); confidence_.reserve(nparts);
+		score_.reserve(n); component_.reserve(n); scale_.reserve(n); offset_.reserve(n+1);
+	}
+	//! swap the contents of two sets
+	void swap(CandidateSet& other) {
+		parts_.swap(other.parts_); confidence_.swap(other.confidence_); score_.swap(other.score_);
+		component_.swap(other.component_); scale_.swap(other.scale_); offset_.swap(other.offset_);
+	}
+
+	/*! @brief append n candidates with the same number of parts
+	 *
+	 * The parts are left empty and the scores set to -infinity, to be
+	 * filled in with setPart(). Distinct candidates may be filled in
+	 * concurrently
+	 *
+	 * @param n the number of candidates to append
+	 * @param nparts the number of parts of each candidate
+	 * @param component the model component of the candidates
+	 * @param scale the scale index of the candidates
+	 * @return the index of the first appended candidate
+	 */
+	unsigned int grow(unsigned int n, unsigned int nparts, int component, int scale) {
+		const unsigned int first = size();
+		parts_.resize(parts_.size() + n*nparts);
+		confidence_.resize(confidence_.size() + n*nparts, 0.0f);
+		score_.resize(first+n, -std::numeric_limits<float>::infinity());
+		component_.resize(first+n, component);
+		scale_.resize(first+n, scale);
+		for (unsigned int i = 0; i < n; ++i) offset_.push_back(offset_.back() + nparts);
+		return first;
+	}
+
+	//! append a Candidate
+	void push_back(const Candidate& candidate, int scale = -1) {
+		const unsigned int i = grow(1, candidate.parts().size(), candidate.component(), scale);
+		for (unsigned int p = 0; p < candidate.parts().size(); ++p) setPart(i, p, candidate.parts()[p], candidate.confidence()[p]);
+	}
+
+	//! append a candidate of another set
+	void push_back(const CandidateSet& other, unsigned int i) {
+		const unsigned int k = grow(1, other.nparts(i), other.component(i), other.scale(i));
+		for (unsigned int p = 0; p < other.nparts(i); ++p) setPart(k, p, other.part(i, p), other.confidence(i, p));
+	}
+
+	//! set a part of a candidate. The confidence of the root part (p == 0) is the candidate's score
+	void setPart(unsigned int i, unsigned int p, const cv::Rect& r, float confidence) {
+		parts_[offset_[i]+p] = r;
+		confidence_[offset_[i]+p] = confidence;
+		if (p == 0) score_[i] = confidence;
+	}
+
+	// accessors
+	unsigned int nparts(unsigned int i) const { return offset_[i+1] - offset_[i]; }
+	const cv::Rect& part(unsigned int i, unsigned int p) const { return parts_[offset_[i]+p]; }
+	float confidence(unsigned int i, unsigned int p) const { return confidence_[offset_[i]+p]; }
+	float score(unsigned int i) const { return score_[i]; }
+	int component(unsigned int i) const { return component_[i]; }
+	int scale(unsigned int i) const { return scale_[i]; }
+	void setScale(unsigned int i, int scale) { scale_[i] = scale; }
+	//! move every part of a candidate by an offset
+	void translate(unsigned int i, const cv::Point& offset) {
+		for (unsigned int n = offset_[i]; n < offset_[i+1]; ++n) parts_[n] += offset;
+	}
+	CandidateView operator[](unsigned int i) const { return CandidateView(*this, i); }
+
+	//! a single bounding box around all the parts of a candidate
+	cv::Rect boundingBox(unsigned int i) const {
+		cv::Rect hull = parts_[offset_[i]];
+		for (unsigned int n = offset_[i]+1; n < offset_[i+1]; ++n) hull = hull | parts_[n];
+		return hull;
+	}
+
+	//! copy a candidate out of the set
+	Candidate candidate(unsigned int i) const {
+		Candidate candidate;
+		candidate.setComponent(component_[i]);
+		for (unsigned int n = offset_[i]; n < offset_[i+1]; ++n) candidate.addPart(parts_[n], confidence_[n]);
+		return candidate;
+	}
+
+	//! append every candidate of the set to a vector of Candidate
+	void toCandidates(vectorCandidate& candidates) const {
+		candidates.reserve(candidates.size() + size());
+		for (unsigned int i = 0; i < size(); ++i) candidates.push_back(candidate(i));
+	}
+
+	/*! @brief Sort the candidates from best to worst, in place
+	 *
+	 * Only the candidate indices are sorted. The arrays are then permuted
+	 * once, so no candidate is copied more than once
+	 */
+	void sort(void) {
+		std::vector<unsigned int> order(size());
+		for (unsigned int i = 0; i < order.size(); ++i) order[i] = i;
+		std::sort(order.begin(), order.end(), ScoreDescending(score_));
+		select(order);
+	}
+
+	/*! @brief suppress non-maximal candidates
+	 *
+	 * Identical to Candidate::nonMaximaSuppression(). The candidates should
+	 * already be sorted from best to worst
+	 *
+	 * @param im the input image from which the candidates were found
+	 * @param overlap the allowable overlap [0.0 1.0)
+	 */
+	void nonMaximaSuppression(const cv::Mat& im, const float overlap=0.0f) {
+
+		// create a scratch space that we can draw on
+		const unsigned int N = size();
+		const cv::Rect bounds = cv::Rect(0,0,0,0) + im.size();
+		cv::Mat scratch = cv::Mat::zeros(im.size(), CV_8U);
+
+		std::vector<unsigned int> keep;
+		for (unsigned int n = 0; n < N; ++n) {
+			cv::Rect box = boundingBox(n) & bounds;
+			cv::Scalar boxsum = sum(scratch(box));
+			if (boxsum[0] / box.area() > overlap) continue;
+			scratch(box) = 1;
+			keep.push_back(n);
+		}
+		select(keep);
+	}
+
+	/*! @brief suppress non-maximal candidates by their overlap with each other
+	 *
+	 * @see Candidate::nonMaximaSuppression(vectorCandidate&, const float, const OverlapCriterion, const unsigned int)
+	 * @param overlap the largest allowable overlap [0.0 1.0)
+	 * @param criterion the measure of overlap
+	 * @param K the maximum number of candidates to keep, or 0 to keep all
+	 */
+	void nonMaximaSuppression(const float overlap, const OverlapCriterion criterion, const unsigned int K=0) {
+
+		std::vector<cv::Rect> boxes(size());
+		for (unsigned int n = 0; n < size(); ++n) boxes[n] = boundingBox(n);
+		std::vector<unsigned int> keep;
+		::nonMaximaSuppression(boxes, score_, overlap, keep, criterion, K);
+		select(keep);
+	}
+
+	/*! @brief rescore overlapping candidates rather than suppressing them
+	 *
+	 * @see ::softNonMaximaSuppression()
+	 * @param method the decay function
+	 * @param overlap the IoU above which candidates are decayed (linear only)
+	 * @param sigma the width of the decay (gaussian only)
+	 * @param thresh the lowest rescored score to keep
+	 */
+	void softNonMaximaSuppression(const SoftSuppression method=SOFT_GAUSSIAN, const float overlap=0.3f, const float sigma=0.5f,
+			const float thresh=-std::numeric_limits<float>::infinity()) {
+
+		std::vector<cv::Rect> boxes(size());
+		for (unsigned int n = 0; n < size(); ++n) boxes[n] = boundingBox(n);
+		std::vector<unsigned int> keep;
+		::softNonMaximaSuppression(boxes, score_, keep, method, overlap, sigma, thresh);
+		for (unsigned int n = 0; n < size(); ++n) confidence_[offset_[n]] = score_[n];
+		select(keep);
+	}
+
+	/*! @brief fuse clusters of overlapping candidates of the same component
+	 *
+	 * Each cluster is replaced by a single candidate whose parts are the
+	 * score weighted mean of the parts of its members, and whose score is
+	 * the mean score of its members
+	 *
+	 * @see ::clusterBoxes()
+	 * @param overlap the IoU above which a candidate joins a cluster
+	 */
+	void fuse(const float overlap=0.55f) {
+
+		std::vector<cv::Rect> boxes(size()), fusedboxes, parts;
+		for (unsigned int n = 0; n < size(); ++n) boxes[n] = boundingBox(n);
+		vectorf weights, partweights;
+		std::vector<std::vector<unsigned int> > clusters;
+		fusionWeights(score_, weights);
+		clusterBoxes(boxes, weights, overlap, clusters, fusedboxes, component_);
+
+		CandidateSet fused;
+		fused.reserve(clusters.size(), clusters.size() * (empty() ? 0 : nparts(0)));
+		for (unsigned int c = 0; c < clusters.size(); ++c) {
+			const std::vector<unsigned int>& members = clusters[c];
+			const unsigned int first = members[0];
+			const unsigned int np = nparts(first);
+			const unsigned int k = fused.grow(1, np, component_[first], scale_[first]);
+
+			float score = 0;
+			partweights.resize(members.size());
+			for (unsigned int m = 0; m < members.size(); ++m) {
+				score += score_[members[m]];
+				partweights[m] = weights[members[m]];
+			}
+			score /= members.size();
+
+			parts.resize(members.size());
+			for (unsigned int p = 0; p < np; ++p) {
+				for (unsigned int m = 0; m < members.size(); ++m) parts[m] = part(members[m], p);
+				fused.setPart(k, p, fuseBoxes(parts, partweights), p == 0 ? score : confidence(first, p));
+			}
+		}
+		swap(fused);
+	}
+};
+
+unsigned int CandidateView::nparts(void) const { return set_->nparts(idx_); }
+const cv::Rect& CandidateView::part(unsigned int p) const { return set_->part(idx_, p); }
+float CandidateView::confidence(unsigned int p) const { return set_->confidence(idx_, p); }
+float CandidateView::score(void) const { return set_->score(idx_); }
+int CandidateView::component(void) const { return set_->component(idx_); }
+int CandidateView::scale(void) const { return set_->scale(idx_); }
+cv::Rect CandidateView::boundingBox(void) const { return set_->boundingBox(idx_); }
+Candidate CandidateView::candidate(void) const { return set_->candidate(idx_); }
+
+#endif /* CANDIDATESET_HPP_ */
@@ -0,0 +1,84 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DetectionBudget.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef DETECTIONBUDGET_HPP_
+#define DETECTIONBUDGET_HPP_
+#include <limits>
+#include <opencv2/core/core.hpp>
+
+/*! @class Deadline
+ *  @brief a point in time after which work should stop
+ *
+ * A default constructed deadline never expires
+ */
+class Deadline {
+private:
+	//! the tick count at which the deadline expires
+	double end_;
+public:
+	Deadline() : end_(std::numeric_limits<double>::infinity()) {}
+	//! a deadline a number of seconds from now
+	explicit Deadline(double seconds) : end_((double)cv::getTickCount() + seconds*cv::getTickFrequency()) {}
+	//! has the deadline passed
+	bool expired(void) const { return end_ < std::numeric_limits<double>::infinity() && (double)cv::getTickCount() > end_; }
+	//! the number of seconds remaining (negative once expired)
+	double remaining(void) const { return (end_ - (double)cv::getTickCount()) / cv::getTickFrequency(); }
+};
+
+/*! @class DetectionBudget
+ *  @brief the time available to detect() and where to spend it first
+ *
+ * Pyramid levels are evaluated in order of priority: nearest the prior
+ * level first (for example the level of the best detection in the
+ * previous frame of a video), or coarse to fine without a prior, since
+ * the coarse levels are the cheapest
+ */
+class DetectionBudget {
+private:
+	//! the time budget, in seconds
+	double seconds_;
+	//! the most likely pyramid level, or -1 if unknown
+	int level_;
+public:
+	DetectionBudget(double seconds, int level = -1) : seconds_(seconds), level_(level) {}
+	double seconds(void) const { return seconds_; }
+	int level(void) const { return level_; }
+	//! the deadline of a detection starting now
+	Deadline deadline(void) const { return Deadline(seconds_); }
+};
+
+#endif /* DETECTIONBUDGET_HPP_ */
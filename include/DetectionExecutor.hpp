@@ -0,0 +1,153 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DetectionExecutor.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef DETECTIONEXECUTOR_HPP_
+#define DETECTIONEXECUTOR_HPP_
+#include <string>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "BoundedQueue.hpp"
+#include "CandidateSet.hpp"
+
+//! the state of an asynchronous detection
+enum DetectionStatus {
+	//! waiting in the executor's queue
+	DETECTION_PENDING,
+	//! being processed by a worker
+	DETECTION_RUNNING,
+	//! finished, with candidates
+	DETECTION_DONE,
+	//! cancelled before it finished
+	DETECTION_CANCELLED,
+	//! not admitted, or evicted from the queue by a newer request
+	DETECTION_REJECTED,
+	//! failed with an exception
+	DETECTION_FAILED
+};
+
+class DetectionFuture;
+class DetectionExecutor;
+//! called on completion of an asynchronous detection
+typedef boost::function<void (const DetectionFuture&)> DetectionCallback;
+
+/*! @class DetectionRequest
+ *  @brief the state shared between an asynchronous detection and its futures
+ */
+class DetectionRequest : public boost::enable_shared_from_this<DetectionRequest> {
+private:
+	friend class DetectionFuture;
+	friend class DetectionExecutor;
+	mutable boost::mutex mutex_;
+	mutable boost::condition_variable finished_;
+	DetectionStatus status_;
+	bool cancel_;
+	std::string error_;
+	CandidateSet candidates_;
+	boost::function<bool (DetectionRequest&)> task_;
+	DetectionCallback callback_;
+	void finish(DetectionStatus status, const std::string& error = std::string());
+public:
+	DetectionRequest() : status_(DETECTION_PENDING), cancel_(false) {}
+	//! has cancellation been requested. Checked by the task between its stages
+	bool cancelled(void) const { boost::mutex::scoped_lock lock(mutex_); return cancel_; }
+	//! the output candidates, written by the task
+	CandidateSet& candidates(void) { return candidates_; }
+};
+
+/*! @class DetectionFuture
+ *  @brief a handle to the result of an asynchronous detection
+ *
+ * Futures are cheap to copy, and all copies refer to the same detection.
+ * A default-constructed future refers to none: valid() is false, and any
+ * other method raises an error
+ */
+class DetectionFuture {
+private:
+	boost::shared_ptr<DetectionRequest> request_;
+	DetectionRequest& state(void) const;
+public:
+	DetectionFuture() {}
+	explicit DetectionFuture(const boost::shared_ptr<DetectionRequest>& request) : request_(request) {}
+	//! does the future refer to a detection
+	bool valid(void) const { return request_.get() != NULL; }
+	DetectionStatus status(void) const;
+	bool ready(void) const;
+	DetectionStatus wait(void) const;
+	bool wait(unsigned int milliseconds) const;
+	DetectionStatus get(CandidateSet& candidates) const;
+	std::string error(void) const;
+	void cancel(void) const;
+};
+
+/*! @class DetectionExecutor
+ *  @brief a pool of worker threads running asynchronous detections
+ *
+ * Requests wait in a queue of fixed length, so at most nthreads requests
+ * run and at most capacity wait at any time. When the queue is full, the
+ * policy decides whether submit() blocks the caller (DROP_NONE, applying
+ * back-pressure), rejects the new request (DROP_NEWEST) or evicts the
+ * oldest waiting request (DROP_OLDEST). Rejected and evicted requests
+ * complete with DETECTION_REJECTED.
+ *
+ * Each detection parallelizes internally with OpenMP, so nthreads should
+ * be small: enough to hide the serial sections of a detection, not one
+ * per core
+ */
+class DetectionExecutor {
+private:
+	//! the requests waiting for a worker
+	BoundedQueue<boost::shared_ptr<DetectionRequest> > queue_;
+	//! what to do with a new request when the queue is full
+	DropPolicy policy_;
+	//! the worker threads
+	boost::thread_group threads_;
+	void work(void);
+	// noncopyable
+	DetectionExecutor(const DetectionExecutor&);
+	DetectionExecutor& operator=(const DetectionExecutor&);
+public:
+	DetectionExecutor(unsigned int nthreads, unsigned int capacity, DropPolicy policy = DROP_NONE);
+	virtual ~DetectionExecutor();
+	DetectionFuture submit(const boost::function<bool (DetectionRequest&)>& task, const DetectionCallback& callback = DetectionCallback());
+	void shutdown(void);
+};
+
+#endif /* DETECTIONEXECUTOR_HPP_ */
@@ -0,0 +1,69 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DetectionRoi.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef DETECTIONROI_HPP_
+#define DETECTIONROI_HPP_
+#include <limits>
+#include <opencv2/core/core.hpp>
+
+/*! @class DetectionRoi
+ *  @brief a region of an image to search, and the scales to search it at
+ *
+ * Scales are those of the feature pyramid (see IFeatures::pyramid()): the
+ * size of a feature cell in image pixels. A part filter h cells tall thus
+ * covers about h*scale pixels. Candidates are kept if the centre of their
+ * bounding box lies within the region
+ */
+class DetectionRoi {
+private:
+	//! the region, in image coordinates
+	cv::Rect rect_;
+	//! the smallest scale to search
+	float minscale_;
+	//! the largest scale to search
+	float maxscale_;
+public:
+	DetectionRoi(const cv::Rect& rect, float minscale = 0.0f, float maxscale = std::numeric_limits<float>::infinity()) :
+		rect_(rect), minscale_(minscale), maxscale_(maxscale) {}
+	const cv::Rect& rect(void) const { return rect_; }
+	float minscale(void) const { return minscale_; }
+	float maxscale(void) const { return maxscale_; }
+	//! does the region search a location at a scale
+	bool contains(const cv::Point& pt, float scale) const { return rect_.contains(pt) && scale >= minscale_ && scale <= maxscale_; }
+};
+
+#endif /* DETECTIONROI_HPP_ */
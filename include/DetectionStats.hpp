@@ -0,0 +1,150 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DetectionStats.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef DETECTIONSTATS_HPP_
+#define DETECTIONSTATS_HPP_
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+
+/*! @class DetectionStats
+ *  @brief the durations, counts and memory of one detection
+ *
+ * Durations are wall-clock seconds. The distance transforms and the
+ * reductions over child mixtures are interleaved part by part, so they
+ * are reported together as message passing
+ */
+struct DetectionStats {
+	//! resampling the image to each level of the pyramid
+	double resize;
+	//! computing the features of each level
+	double features;
+	//! convolving the features with the filters, in total and for each level
+	double convolution;
+	std::vector<double> levelconvolution;
+	//! passing messages from the leaves to the root (distance transforms and reductions)
+	double messages;
+	//! selecting the best root locations. The dense non-maxima suppression of the
+	//! root scores is part of top-K selection, so is not timed separately. Suppression
+	//! of overlapping boxes (CandidateSet::nonMaximaSuppression()) runs after
+	//! detection, so is not included
+	double selection;
+	//! backtracking the part locations of the selected candidates
+	double argmin;
+	//! the whole detection
+	double total;
+	//! the number of pyramid levels
+	unsigned int levels;
+	//! the number of filters, and the number of filter responses computed
+	unsigned int filters, responses;
+	//! the number of candidates returned
+	unsigned int candidates;
+	//! the size of the features, the filter responses and the state of the dynamic program, in bytes
+	size_t featurebytes, responsebytes, dpbytes;
+	DetectionStats() { clear(); }
+	//! reset every duration, count and size to zero
+	void clear(void) {
+		resize = features = convolution = messages = selection = argmin = total = 0;
+		levelconvolution.clear();
+		levels = filters = responses = candidates = 0;
+		featurebytes = responsebytes = dpbytes = 0;
+	}
+	//! the peak size of the intermediate state, in bytes. Leaf messages which share
+	//! the data of their responses are counted twice, so this is an upper bound
+	size_t peakbytes(void) const { return featurebytes + responsebytes + dpbytes; }
+};
+
+/*! @class IStatsSink
+ *  @brief a destination for the stats of each detection
+ *
+ * PartsBasedDetector::detect() may be called from any number of threads,
+ * so implementations of write() must be thread-safe
+ */
+class IStatsSink {
+public:
+	virtual ~IStatsSink() {}
+	/*! @brief record the stats of a detection
+	 *
+	 * @param stats the stats
+	 */
+	virtual void write(const DetectionStats& stats) = 0;
+};
+
+/*! @class JsonLinesStatsSink
+ *  @brief appends the stats of each detection to a file, as one JSON object per line
+ */
+class JsonLinesStatsSink : public IStatsSink {
+private:
+	std::ofstream file_;
+	boost::mutex mutex_;
+public:
+	explicit JsonLinesStatsSink(const std::string& path);
+	virtual ~JsonLinesStatsSink() {}
+	virtual void write(const DetectionStats& stats);
+};
+
+/*! @class PrometheusStatsSink
+ *  @brief keeps running totals of the stats, exported as a Prometheus text file
+ *
+ * After each detection the file is rewritten in the Prometheus text
+ * exposition format, for the node exporter's textfile collector. The file
+ * is written alongside and renamed into place, so it is never read half
+ * written. Durations and counts are cumulative counters, and the peak
+ * bytes are the largest seen
+ */
+class PrometheusStatsSink : public IStatsSink {
+private:
+	//! the path of the text file
+	std::string path_;
+	//! the prefix of each metric name
+	std::string prefix_;
+	//! the running totals
+	DetectionStats totals_;
+	//! the number of detections
+	unsigned long detections_;
+	//! the largest peak bytes
+	size_t peakbytes_;
+	boost::mutex mutex_;
+public:
+	PrometheusStatsSink(const std::string& path, const std::string& prefix = "pbd");
+	virtual ~PrometheusStatsSink() {}
+	virtual void write(const DetectionStats& stats);
+};
+
+#endif /* DETECTIONSTATS_HPP_ */
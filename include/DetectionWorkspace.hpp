@@ -0,0 +1,118 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DetectionWorkspace.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef DETECTIONWORKSPACE_HPP_
+#define DETECTIONWORKSPACE_HPP_
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include "IConvolutionEngine.hpp"
+
+/*! @class DetectionWorkspace
+ *  @brief the mutable state of one call to PartsBasedDetector::detect()
+ *
+ * The model held by a PartsBasedDetector is immutable during detection,
+ * so any number of threads may call detect() on the same detector, as long
+ * as each uses its own workspace. A workspace is bound to the convolution
+ * engine it was last used with, and is rebuilt if used with another (for
+ * example after PartsBasedDetector::distributeModel()), so keeping a
+ * workspace between calls avoids rebuilding it for every image
+ */
+class DetectionWorkspace {
+private:
+	//! the engine the convolution workspace was created by
+	boost::shared_ptr<const IConvolutionEngine> engine_;
+	//! the scratch state of the convolution engine
+	boost::scoped_ptr<IConvolutionWorkspace> convolution_;
+	// noncopyable
+	DetectionWorkspace(const DetectionWorkspace&);
+	DetectionWorkspace& operator=(const DetectionWorkspace&);
+public:
+	DetectionWorkspace() {}
+	virtual ~DetectionWorkspace() {}
+	/*! @brief the convolution workspace for an engine
+	 *
+	 * @param engine the convolution engine
+	 * @return the workspace, created if it was not created by engine
+	 */
+	IConvolutionWorkspace& convolution(const boost::shared_ptr<const IConvolutionEngine>& engine) {
+		if (engine_ != engine || !convolution_) {
+			convolution_.reset(engine->createWorkspace());
+			engine_ = engine;
+		}
+		return *convolution_;
+	}
+	//! release the scratch state
+	void clear(void) {
+		convolution_.reset();
+		engine_.reset();
+	}
+};
+
+/*! @class DetectionWorkspacePool
+ *  @brief a thread-safe pool of DetectionWorkspaces
+ *
+ * acquire() lends a workspace from the pool, creating one if none are
+ * free. The workspace returns to the pool when the last copy of the
+ * returned pointer is destroyed, which must happen before the pool is
+ * destroyed. The pool grows to the number of concurrent callers
+ *
+ * \code
+ * DetectionWorkspacePool pool;
+ * // in each thread
+ * boost::shared_ptr<DetectionWorkspace> workspace = pool.acquire();
+ * pbd.detect(im, Mat(), candidates, *workspace);
+ * \endcode
+ */
+class DetectionWorkspacePool {
+private:
+	//! the workspaces not currently lent
+	std::vector<DetectionWorkspace*> free_;
+	boost::mutex mutex_;
+	void release(DetectionWorkspace* workspace);
+	// noncopyable
+	DetectionWorkspacePool(const DetectionWorkspacePool&);
+	DetectionWorkspacePool& operator=(const DetectionWorkspacePool&);
+public:
+	DetectionWorkspacePool() {}
+	virtual ~DetectionWorkspacePool();
+	boost::shared_ptr<DetectionWorkspace> acquire(void);
+	void clear(void);
+};
+
+#endif /* DETECTIONWORKSPACE_HPP_ */
@@ -41,9 +41,12 @@
 #include <vector>
 #include <opencv2/core/core.hpp>
 #include "Candidate.hpp"
+#include "CandidateSet.hpp"
+#include "DetectionBudget.hpp"
 #include "DistanceTransform.hpp"
 #include "Model.hpp"
 #include "Parts.hpp"
+#include "PartSchedule.hpp"
 #include "types.hpp"
 
 
@@ -63,16 +66,91 @@ class DynamicProgram {
 private:
 	//! the threshold for a positive detection
 	double thresh_;
+	//! recompute part placements in argmin() rather than storing the argmax maps in min()
+	bool ondemand_;
+	//! the half-width of the window searched about each anchor when backtracking on demand
+	int window_;
+	//! the number of detections to keep before backtracking (0 keeps all)
+	unsigned int topk_;
+	//! the cascade stage thresholds of each component (empty if disabled)
+	vector2Df cascadethresh_;
+	//! the order in which the subtrees of each component's root are evaluated by the cascade
+	vector2Di cascadeorder_;
+	//! the flattened tree of parts, compiled from the Parts by compile()
+	PartSchedule<T> schedule_;
 	DistanceTransform<T> dt_;
 	void distanceTransform1D(const T* src, T* dst, int* ptr, unsigned int n, T a, T b, int os);
 	void distanceTransform1DMat(const cv::Mat_<T>& src, cv::Mat_<T>& dst, cv::Mat_<int>& ptr, unsigned int N, T a, T b, int os);
+	void rootScore(const vectorMat& scores, unsigned int c, const vectorMat& ncscores, cv::Mat& maxv, cv::Mat& maxi) const;
+	void minSubtree(const vectorMat& scores, unsigned int c, unsigned int begin, unsigned int end, vectorMat& ncscores,
+			vector2DMat* Ix, vector2DMat* Iy, vector2DMat* Ik, vectorMat& rootmsg, bool parallel) const;
+	void minComponent(const vectorMat& scores, unsigned int c, vectorMat& ncscores, vector2DMat* Ix, vector2DMat* Iy, vector2DMat* Ik, cv::Mat& rootv, cv::Mat& rooti, vectorMat* stages, bool parallel) const;
+	static bool parallelWithin(unsigned int nunits);
+	void checkCascade(const vector2Df& thresh, const vector2Di& order) const;
+	void skipComponent(const vectorMat& scores, unsigned int c, cv::Mat& rootv, cv::Mat& rooti) const;
+	void allocateCandidates(const vector2DMat& rootv, CandidateSet& candidates, vectori& offsets) const;
+	T localArgmax(const cv::Mat& message, const typename PartSchedule<T>::Mixture& mixture, const cv::Point parent, cv::Point& child) const;
 public:
-	DynamicProgram() {}
-	DynamicProgram(double thresh) : thresh_(thresh) {}
+	DynamicProgram() : thresh_(0), ondemand_(false), window_(5), topk_(0) {}
+	DynamicProgram(double thresh) : thresh_(thresh), ondemand_(false), window_(5), topk_(0) {}
 	virtual ~DynamicProgram() {}
+	// get and set methods
+	void setThreshold(double thresh) { thresh_ = thresh; }
+	double threshold(void) const { return thresh_; }
+	/*! @brief trade the argmax maps for a local search during argmin()
+	 *
+	 * When enabled, min() keeps only the score messages of each part, and argmin()
+	 * recovers each part's placement by searching a (2*window+1)^2 neighbourhood
+	 * about its anchor, for the selected root locations only
+	 *
+	 * @param ondemand enable or disable backtracking on demand
+	 * @param window the half-width of the search window, in feature cells
+	 */
+	void setBacktrackOnDemand(bool ondemand, int window = 5) { ondemand_ = ondemand; window_ = window; }
+	bool backtrackOnDemand(void) const { return ondemand_; }
+	int window(void) const { return window_; }
+	/*! @brief keep only the best detections before backtracking
+	 *
+	 * @see selectTopK()
+	 * @param k the number of detections to keep, or 0 to keep all
+	 */
+	void setTopK(unsigned int k) { topk_ = k; }
+	unsigned int topK(void) const { return topk_; }
+	/*! @brief set the cascade thresholds
+	 *
+	 * Stage 0 of a component's cascade is its root filter. Stage s > 0 adds
+	 * the messages of the root's subtree order[s-1]. Root locations whose
+	 * partial score falls below thresh[s] are discarded. Components with
+	 * no thresholds are evaluated in full. Once compiled, the cascade is
+	 * checked against the tree of parts (see compile())
+	 *
+	 * @param thresh the stage thresholds of each component
+	 * @param order the order in which the subtrees of each component's root are evaluated
+	 */
+	void setCascade(const vector2Df& thresh, const vector2Di& order) {
+		checkCascade(thresh, order);
+		if (!schedule_.empty()) schedule_.setOrder(order);
+		cascadethresh_ = thresh;
+		cascadeorder_  = order;
+	}
+	//! does any component have a cascade
+	bool cascade(void) const { return !cascadethresh_.empty(); }
+	//! does component c have a cascade
+	bool cascade(unsigned int c) const { return c < cascadethresh_.size() && !cascadethresh_[c].empty(); }
+	//! the compiled schedule
+	const PartSchedule<T>& schedule(void) const { return schedule_; }
 	// public methods
-	void min(Parts& parts, vector2DMat& scores, vector4DMat& Ix, vector4DMat& Iy, vector4DMat& Ik, vector2DMat& rootv, vector2DMat& rooti);
-	void argmin(Parts& parts, const vector2DMat& rootv, const vector2DMat& rooti, const vectorf scales, const vector4DMat& Ix, const vector4DMat& Iy, const vector4DMat& Ik, vectorCandidate& candidates);
+	void compile(Parts& parts);
+	void prune(const vector2DMat& scores, vector2Di& alive) const;
+	void filterMask(const vector2Di& alive, bool roots, vector2Di& mask) const;
+	void stageScores(vector2DMat& scores, vector3DMat& stages, vector2DMat& rootv, vector2DMat& rooti) const;
+	bool min(vector2DMat& scores, vector4DMat& Ix, vector4DMat& Iy, vector4DMat& Ik, vector2DMat& rootv, vector2DMat& rooti, const Deadline& deadline = Deadline()) const;
+	bool min(vector2DMat& scores, vector3DMat& messages, vector2DMat& rootv, vector2DMat& rooti, const Deadline& deadline = Deadline()) const;
+	void selectTopK(vector2DMat& rootv) const;
+	void argmin(const vector2DMat& rootv, const vector2DMat& rooti, const vectorf scales, const vector4DMat& Ix, const vector4DMat& Iy, const vector4DMat& Ik, CandidateSet& candidates) const;
+	void argmin(const vector2DMat& rootv, const vector2DMat& rooti, const vectorf scales, const vector3DMat& messages, CandidateSet& candidates) const;
+	void argmin(const vector2DMat& rootv, const vector2DMat& rooti, const vectorf scales, const vector4DMat& Ix, const vector4DMat& Iy, const vector4DMat& Ik, vectorCandidate& candidates) const;
+	void argmin(const vector2DMat& rootv, const vector2DMat& rooti, const vectorf scales, const vector3DMat& messages, vectorCandidate& candidates) const;
 	void distanceTransform(const cv::Mat& score_in, const vectorf w, cv::Point os, cv::Mat& score_out, cv::Mat& Ix, cv::Mat& Iy);
 };
 
@@ -40,6 +40,7 @@
 #define HOGFEATURES_HPP_
 #include <vector>
 #include <cstdio>
+#include <limits>
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include "IFeatures.hpp"
@@ -53,21 +54,19 @@ class HOGFeatures : public IFeatures {
 private:
 	//! the spatial binning size
 	unsigned int binsize_;
-	//! the number of scales to compute features at
+	//! the number of scales per halving of the resolution
 	unsigned int nscales_;
 	//! the length of the feature at each bin (histogram size)
 	unsigned int flen_;
 	//! the number of orientations to bin
 	unsigned int norient_;
-	//! the scales of the features
-	vectorf scales_;
 	//! the scaling factor between successive levels in the pyramid
 	float sfactor_;
 	//! the interval between half resolution scales
 	unsigned int interval_;
 
 	// private methods
-	void boundaryOcclusionFeature(cv::Mat& feature, const int flen, const int padsize);
+	void boundaryOcclusionFeature(cv::Mat& feature, const int flen, const int padsize) const;
 	template<typename IT> void features(const cv::Mat& im, cv::Mat& feature) const;
 public:
 	HOGFeatures() {}
@@ -83,8 +82,10 @@ public:
 	// get methods
 	unsigned int binsize(void) const { return binsize_; }
 	unsigned int nscales(void) const { return nscales_; }
-	vectorf scales(void) const { return scales_; }
-	void pyramid(const cv::Mat& im, vectorMat& pyrafeatures);
+	void pyramid(const cv::Mat& im, vectorMat& pyrafeatures, vectorf& scales) const;
+	void pyramid(const cv::Mat& im, float minscale, float maxscale, vectorMat& pyrafeatures, vectorf& scales) const;
+	void images(const cv::Mat& im, vectorMat& pyraimages, vectorf& scales) const;
+	void features(const cv::Mat& im, cv::Mat& feature) const;
 };
 
 #endif /* HOGFEATURES_HPP_ */
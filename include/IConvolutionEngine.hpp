@@ -41,6 +41,18 @@
 
 #include "types.hpp"
 
+/*! @class IConvolutionWorkspace
+ *  @brief the mutable state of a convolution engine
+ *
+ * An engine's filters are shared by every caller, but any scratch state
+ * the engine needs while convolving lives in a workspace, which may only
+ * be used by one caller at a time
+ */
+class IConvolutionWorkspace {
+public:
+	virtual ~IConvolutionWorkspace() {}
+};
+
 class IConvolutionEngine {
 public:
 	virtual ~IConvolutionEngine() {}
@@ -55,6 +67,36 @@ public:
 	 */
 	virtual void pdf(const vectorMat& features, vector2DMat& responses) = 0;
 
+	/*! @brief probability density function, for a subset of the responses
+	 *
+	 * As above, but only the responses selected by the mask are computed. All
+	 * other responses are left untouched, so a set of responses can be built
+	 * up over several calls
+	 *
+	 * @param features the input pyramid of features
+	 * @param responses a 2D vector of pdfs, 1st dimension across scale, 2nd dimension across filter
+	 * @param mask nonzero for each (scale, filter) response to compute. An empty mask selects all responses
+	 */
+	virtual void pdf(const vectorMat& features, vector2DMat& responses, const vector2Di& mask) = 0;
+
+	/*! @brief probability density function, using the caller's workspace
+	 *
+	 * As above, but the engine itself is not modified, so any number of
+	 * threads may call this method concurrently, each with its own workspace
+	 *
+	 * @param features the input pyramid of features
+	 * @param responses a 2D vector of pdfs, 1st dimension across scale, 2nd dimension across filter
+	 * @param mask nonzero for each (scale, filter) response to compute. An empty mask selects all responses
+	 * @param workspace a workspace created by createWorkspace() after the last call to setFilters()
+	 */
+	virtual void pdf(const vectorMat& features, vector2DMat& responses, const vector2Di& mask, IConvolutionWorkspace& workspace) const = 0;
+
+	/*! @brief create a workspace for the current filters
+	 *
+	 * @return a new workspace, owned by the caller
+	 */
+	virtual IConvolutionWorkspace* createWorkspace(void) const = 0;
+
 	/*! @brief set the convolve engine filters
 	 *
 	 * In many situations, the filters are static during operation of the detector
@@ -65,6 +107,26 @@ public:
 	 * @param filters the vector of filters
 	 */
 	virtual void setFilters(const vectorMat& filters) = 0;
+
+	/*! @brief lay out a set of filters for this engine
+	 *
+	 * Produces the layout that setFilters() builds internally, so that it
+	 * can be computed once (see ModelCompiler) and stored with the model
+	 *
+	 * @param filters the vector of filters
+	 * @param compiled the filters in the engine's layout
+	 */
+	virtual void compileFilters(const vectorMat& filters, vector2DMat& compiled) const = 0;
+
+	/*! @brief set the convolve engine filters, as laid out by compileFilters()
+	 *
+	 * The filters are used as they are, without copying
+	 *
+	 * @param compiled the filters in the engine's layout
+	 * @return false if the layout does not suit the engine (such as a different
+	 * precision), in which case the filters are unchanged
+	 */
+	virtual bool setCompiledFilters(const vector2DMat& compiled) = 0;
 };
 
 
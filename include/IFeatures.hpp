@@ -52,24 +52,55 @@ public:
 	// get and set methods
 	//! retrieve the spatial binning size (1 if not relevant)
 	virtual unsigned int binsize(void) const = 0;
-	//! retrieve the number of scales the features are calculated over
+	//! retrieve the number of scales per halving of the resolution
 	virtual unsigned int nscales(void) const = 0;
 	// public methods
-	/*! @brief the vector of scales
+	/*! @brief a pyramid of features
+	 *
+	 * features calculated of a number of scales. The feature engine is not
+	 * modified, so pyramids may be computed concurrently
 	 *
-	 * the vector of scales, 1 indicating the native image resolution,
+	 * @param im the input image to calculate features for
+	 * @param pyrafeatures an output vector of matrices of features, one matrix for each scale
+	 * @param scales the output scale of each matrix, 1 indicating the native image resolution,
 	 * values lower than 1 indicating downsampled images, and values greater
 	 * than 1 indicating hallucinated resolutions
 	 */
-	virtual vectorf scales(void) const = 0;
+	virtual void pyramid(const cv::Mat& im, vectorMat& pyrafeatures, vectorf& scales) const = 0;
 
-	/*! @brief a pyramid of features
+	/*! @brief a pyramid of features, over a range of scales
+	 *
+	 * As above, but the features of levels whose scale lies outside
+	 * [minscale, maxscale] are not computed, and are left empty
 	 *
-	 * features calculated of a number of scales
 	 * @param im the input image to calculate features for
+	 * @param minscale the smallest scale to compute
+	 * @param maxscale the largest scale to compute
 	 * @param pyrafeatures an output vector of matrices of features, one matrix for each scale
+	 * @param scales the output scale of every level, including those not computed
+	 */
+	virtual void pyramid(const cv::Mat& im, float minscale, float maxscale, vectorMat& pyrafeatures, vectorf& scales) const = 0;
+
+	/*! @brief the images from which a pyramid of features is calculated
+	 *
+	 * pyramid() is equivalent to calling features() on each of these images
+	 *
+	 * @param im the input image
+	 * @param pyraimages an output vector of the input image resampled to each scale
+	 * @param scales the output scale of each image
+	 */
+	virtual void images(const cv::Mat& im, vectorMat& pyraimages, vectorf& scales) const = 0;
+
+	/*! @brief the features of an image at its own resolution
+	 *
+	 * Features are computed over cells of binsize() pixels, so the features of
+	 * a subregion aligned to the cell grid match those of the whole image away
+	 * from the edges of the subregion
+	 *
+	 * @param im the input image
+	 * @param feature the output features
 	 */
-	virtual void pyramid(const cv::Mat& im, vectorMat& pyrafeatures) = 0;
+	virtual void features(const cv::Mat& im, cv::Mat& feature) const = 0;
 };
 
 //IFeatures::~IFeatures() {}
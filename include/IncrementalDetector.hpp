@@ -0,0 +1,118 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    IncrementalDetector.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef INCREMENTALDETECTOR_HPP_
+#define INCREMENTALDETECTOR_HPP_
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "CandidateSet.hpp"
+#include "DetectionWorkspace.hpp"
+#include "PartsBasedDetector.hpp"
+#include "types.hpp"
+
+/*! @class IncrementalDetector
+ *  @brief a detector for static cameras which only recomputes what has changed
+ *
+ * IncrementalDetector keeps the features, filter responses, part messages and
+ * root scores of every pyramid level between frames. Each new frame is
+ * compared with the last (or a changed-pixel mask is supplied), and the
+ * feature map of each level is divided into tiles. Only the tiles touched
+ * by a change are recomputed, each over a halo large enough that:
+ *
+ * - the features match those of the whole frame (2 cells, for the gradient,
+ *   orientation voting and block normalization)
+ * - the filter responses match those of the whole frame (the largest filter)
+ * - the messages and root scores approximate those of the whole frame (the
+ *   extent of the model plus the backtracking window). The distance transform
+ *   is unbounded, so a part placed beyond the halo is not seen, but the
+ *   quadratic deformation cost makes such placements vanishingly rare
+ *
+ * Messages are kept for backtracking on demand (see
+ * PartsBasedDetector::setBacktrackOnDemand()), whatever the detector's setting.
+ * The first frame, and any frame of a different size, is processed in full
+ *
+ * \code
+ * IncrementalDetector<float> incremental(pbd);
+ * while (capture.read(frame)) {
+ * 	CandidateSet candidates;
+ * 	incremental.detect(frame, candidates);
+ * }
+ * \endcode
+ */
+template<typename T>
+class IncrementalDetector {
+private:
+	//! the detector whose model is used
+	const PartsBasedDetector<T>& detector_;
+	//! the width and height of a tile, in feature cells
+	unsigned int tile_;
+	//! the absolute difference at which a pixel has changed
+	int threshold_;
+	//! the previous frame
+	cv::Mat previous_;
+	//! the scale of each level of the pyramid
+	vectorf scales_;
+	//! the features of each level
+	vectorMat features_;
+	//! the response of each filter at each level
+	vector2DMat pdf_;
+	//! the part messages of each level and component
+	vector3DMat messages_;
+	//! the root scores and mixtures of each level and component
+	vector2DMat rootv_, rooti_;
+	//! the convolution workspace
+	DetectionWorkspace workspace_;
+	//! the fraction of tiles recomputed by message passing in the last frame
+	double dirty_;
+	void full(const cv::Mat& im);
+	void update(const cv::Mat& im, const cv::Mat& changed);
+public:
+	IncrementalDetector(const PartsBasedDetector<T>& detector, unsigned int tile = 16, int threshold = 10) :
+		detector_(detector), tile_(tile), threshold_(threshold), dirty_(1.0) {}
+	virtual ~IncrementalDetector() {}
+	void detect(const cv::Mat& im, CandidateSet& candidates, const cv::Mat& changed = cv::Mat());
+	//! discard the cached state, so that the next frame is processed in full
+	void reset(void) { previous_.release(); }
+	//! the fraction of the frame recomputed in the last call to detect()
+	double dirty(void) const { return dirty_; }
+	//! the cached features of each level
+	const vectorMat& features(void) const { return features_; }
+	//! the cached response of each filter at each level
+	const vector2DMat& pdf(void) const { return pdf_; }
+};
+
+#endif /* INCREMENTALDETECTOR_HPP_ */
@@ -91,6 +91,54 @@ public:
 	}
 
 
+	/*! @brief count the elements of a matrix greater than a threshold
+	 *
+	 * The inner loop is branch free, so it vectorizes
+	 *
+	 * @param src the input single channel matrix
+	 * @param thresh the threshold
+	 * @return the number of elements of src greater than thresh
+	 */
+	template<typename T>
+	static unsigned int countGreater(const cv::Mat& src, const T thresh) {
+
+		unsigned int M = src.rows;
+		unsigned int N = src.cols;
+		if (src.isContinuous()) { N = M*N; M = 1; }
+		unsigned int count = 0;
+		for (unsigned int m = 0; m < M; ++m) {
+			const T* src_ptr = src.ptr<T>(m);
+			for (unsigned int n = 0; n < N; ++n) count += (src_ptr[n] > thresh);
+		}
+		return count;
+	}
+
+
+	/*! @brief find the elements of a matrix greater than a threshold
+	 *
+	 * Equivalent to find(src > thresh, idx), but in a single pass over src
+	 * and without allocating the intermediate binary matrix. Rows with no
+	 * elements over threshold are rejected by a branch free scan
+	 *
+	 * @param src the input single channel matrix
+	 * @param thresh the threshold
+	 * @param idx the output vector of indices over threshold
+	 */
+	template<typename T>
+	static void findGreater(const cv::Mat& src, const T thresh, std::vector<cv::Point>& idx) {
+
+		const unsigned int M = src.rows;
+		const unsigned int N = src.cols;
+		for (unsigned int m = 0; m < M; ++m) {
+			const T* src_ptr = src.ptr<T>(m);
+			unsigned int count = 0;
+			for (unsigned int n = 0; n < N; ++n) count += (src_ptr[n] > thresh);
+			if (count == 0) continue;
+			for (unsigned int n = 0; n < N; ++n) if (src_ptr[n] > thresh) idx.push_back(cv::Point(n,m));
+		}
+	}
+
+
 	/*! @brief Reduce a vector of matrices via indexing
 	 *
 	 * Reduce a 3D matrix (represented as a vector of matrices using cv::split() )
@@ -182,6 +230,84 @@ public:
 		}
 	}
 
+
+	/*! @brief Reduce a vector of biased matrices via elementwise max, accumulating the result
+	 *
+	 * Equivalent to adding bias[k] to each in[k], calling reduceMax(), picking
+	 * Ix and Iy with reducePickIndex() and adding the maximal values to accum,
+	 * but in a single pass over the inputs and without any temporaries.
+	 *
+	 * accum[i][j] += max_k (in[k][i][j] + bias[k])
+	 *
+	 * If Ix or Iy are empty, the maximal indices are not computed and maxi,
+	 * Ixout and Iyout are left untouched
+	 *
+	 * @param in the input 3D matrix
+	 * @param bias the bias to add to each input matrix (bias.size() == in.size())
+	 * @param Ix the x indices to pick from at each maximal element (may be empty)
+	 * @param Iy the y indices to pick from at each maximal element (may be empty)
+	 * @param accum the 2D matrix to add the maximal values to
+	 * @param maxi the output 2D matrix, containing the maximal indices
+	 * @param Ixout the output 2D matrix, containing the x indices picked
+	 * @param Iyout the output 2D matrix, containing the y indices picked
+	 */
+	template<typename T>
+	static void reduceMaxAccumulate(const vectorMat& in, const std::vector<T>& bias, const vectorMat& Ix, const vectorMat& Iy,
+			cv::Mat& accum, cv::Mat& maxi, cv::Mat& Ixout, cv::Mat& Iyout) {
+
+		// error checking
+		const unsigned int K = in.size();
+		const bool keepargmax = !Ix.empty() && !Iy.empty();
+		assert(K > 0 && bias.size() == K);
+		assert(accum.size() == in[0].size() && accum.type() == in[0].type());
+		for (unsigned int k = 1; k < K; ++k) assert(in[k].size() == in[k-1].size());
+
+		// allocate the output matrices
+		if (keepargmax) {
+			maxi.create(in[0].size(), cv::DataType<int>::type);
+			Ixout.create(in[0].size(), cv::DataType<int>::type);
+			Iyout.create(in[0].size(), cv::DataType<int>::type);
+		}
+
+		unsigned int M = in[0].rows;
+		unsigned int N = in[0].cols;
+		bool continuous = accum.isContinuous();
+		for (unsigned int k = 0; k < K; ++k) continuous = continuous && in[k].isContinuous();
+		if (continuous) { N = M*N; M = 1; }
+
+		std::vector<const T*> in_ptr(K);
+		std::vector<const int*> Ix_ptr(keepargmax ? K : 0);
+		std::vector<const int*> Iy_ptr(keepargmax ? K : 0);
+		for (unsigned int m = 0; m < M; ++m) {
+			T* accum_ptr = accum.ptr<T>(m);
+			for (unsigned int k = 0; k < K; ++k) in_ptr[k] = in[k].ptr<T>(m);
+			if (keepargmax) {
+				int* maxi_ptr = maxi.ptr<int>(m);
+				int* Ixout_ptr = Ixout.ptr<int>(m);
+				int* Iyout_ptr = Iyout.ptr<int>(m);
+				for (unsigned int k = 0; k < K; ++k) { Ix_ptr[k] = Ix[k].ptr<int>(m); Iy_ptr[k] = Iy[k].ptr<int>(m); }
+				for (unsigned int n = 0; n < N; ++n) {
+					T v = in_ptr[0][n] + bias[0];
+					int i = 0;
+					for (unsigned int k = 1; k < K; ++k) {
+						const T vk = in_ptr[k][n] + bias[k];
+						if (vk > v) { i = k; v = vk; }
+					}
+					accum_ptr[n] += v;
+					maxi_ptr[n]  = i;
+					Ixout_ptr[n] = Ix_ptr[i][n];
+					Iyout_ptr[n] = Iy_ptr[i][n];
+				}
+			} else {
+				for (unsigned int n = 0; n < N; ++n) {
+					T v = in_ptr[0][n] + bias[0];
+					for (unsigned int k = 1; k < K; ++k) v = std::max(v, in_ptr[k][n] + bias[k]);
+					accum_ptr[n] += v;
+				}
+			}
+		}
+	}
+
 };
 
 
@@ -41,6 +41,7 @@
 #include <vector>
 #include <string>
 #include <opencv2/core/core.hpp>
+#include <boost/shared_ptr.hpp>
 #include "types.hpp"
 
 /*! @class Model
@@ -91,11 +92,20 @@ protected:
 	int flen_;
 	//! the number of orientations per HOG feature bin
 	int norient_;
+	//! the cascade stage thresholds of each component (empty if the model has no cascade)
+	vector2Df 	cascadethresh_;
+	//! the order in which the subtrees of each component's root are evaluated by the cascade
+	vector2Di 	cascadeorder_;
+	//! the filters laid out for the convolution engine (empty if the model has not been compiled)
+	vector2DMat compiled_;
+	//! the storage the filters refer to, if they do not own their data (such as a mapped file)
+	boost::shared_ptr<const void> storage_;
 
 public:
 	Model() {}
 	virtual ~Model() {}
 	vectorMat& filters(void) { return filtersw_; }
+	vector2DMat& compiledFilters(void) { return compiled_; }
 	vectori& filtersi(void) { return filtersi_; }
 	vector2Df& def(void) { return defw_; }
 	vectori& defi(void) { return defi_; }
@@ -116,6 +126,11 @@ public:
 	int flen(void) const { return flen_; }
 	int norient(void) const { return norient_; }
 	int ncomponents(void) const { return filterid_.size(); }
+	vector2Df& cascadeThresh(void) { return cascadethresh_; }
+	vector2Di& cascadeOrder(void) { return cascadeorder_; }
+	boost::shared_ptr<const void> storage(void) const { return storage_; }
+
+	bool validate(std::string& problem) const;
 
 	virtual bool serialize(const std::string& filename) const = 0;
 	virtual bool deserialize(const std::string& filename) = 0;
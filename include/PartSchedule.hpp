@@ -0,0 +1,133 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    PartSchedule.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef PARTSCHEDULE_HPP_
+#define PARTSCHEDULE_HPP_
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "Parts.hpp"
+#include "types.hpp"
+
+/*! @class PartSchedule
+ *  @brief a flattened, precompiled traversal of the Parts trees
+ *
+ *  ComponentPart resolves every parameter through several levels of
+ *  indirection, and returns biases and deformation weights by value.
+ *  That is fine for occasional lookups, but the inner loops of the
+ *  DynamicProgram visit every part and mixture at every scale.
+ *
+ *  PartSchedule resolves the indices once (when the model is distributed)
+ *  into flat arrays of plain records, in the precision of the detector.
+ *  It also stores the order in which each component's parts are visited
+ *  during message passing: the subtrees of the root one at a time, each
+ *  in descending order so that every part follows all of its descendants
+ */
+template<typename T>
+class PartSchedule {
+public:
+	//! a single mixture of a part
+	struct Mixture {
+		//! the index of the filter (and its score) in the monolithic pool
+		int filter;
+		//! the anchor position relative to the parent
+		cv::Point anchor;
+		//! the quadratic deformation coefficients in x and y
+		T ax, bx, ay, by;
+		//! the size of the part
+		int xsize, ysize;
+		//! the offset of the bias row (one entry per parent mixture)
+		int bias;
+	};
+	//! a single part of a component
+	struct Node {
+		//! the part index within its component
+		int self;
+		//! the parent part index (-1 for the root)
+		int parent;
+		//! the number of mixtures of the part and of its parent
+		int nmixtures, pnmixtures;
+		//! the offset of the part's first mixture
+		int mixtures;
+		//! the child of the root which the part descends from (0 for the root)
+		int subtree;
+	};
+private:
+	//! the parts of all components
+	std::vector<Node> nodes_;
+	//! the mixtures of all parts
+	std::vector<Mixture> mixtures_;
+	//! the bias rows of all mixtures
+	std::vector<T> bias_;
+	//! the offset of each component's root in nodes_
+	vectori components_;
+	//! the bias of each component's root
+	std::vector<T> rootbias_;
+	//! the message passing order of each component
+	vector2Di order_;
+	//! the end of each subtree of the root within order_
+	vector2Di stages_;
+	//! the number of filters in the monolithic pool
+	unsigned int nfilters_;
+public:
+	PartSchedule() : nfilters_(0) {}
+	virtual ~PartSchedule() {}
+	void compile(Parts& parts);
+	void setOrder(const vector2Di& order);
+	cv::Rect extent(unsigned int c) const;
+	//! has the schedule been compiled
+	bool empty(void) const { return nodes_.empty(); }
+	//! the number of components
+	unsigned int ncomponents(void) const { return components_.size(); }
+	//! the number of parts in component c
+	unsigned int nparts(unsigned int c) const { return ((c+1 < components_.size()) ? components_[c+1] : nodes_.size()) - components_[c]; }
+	//! the number of filters in the monolithic pool
+	unsigned int nfilters(void) const { return nfilters_; }
+	//! part p of component c
+	const Node& node(unsigned int c, unsigned int p) const { return nodes_[components_[c]+p]; }
+	//! mixture m of a part
+	const Mixture& mixture(const Node& node, unsigned int m) const { return mixtures_[node.mixtures+m]; }
+	//! the bias of a mixture, given the parent mixture
+	T bias(const Mixture& mixture, unsigned int pm) const { return bias_[mixture.bias+pm]; }
+	//! the bias of the root of component c
+	T rootBias(unsigned int c) const { return rootbias_[c]; }
+	//! the message passing order of component c, excluding the root
+	const vectori& order(unsigned int c) const { return order_[c]; }
+	//! the end of each subtree of the root of component c within order(c)
+	const vectori& stages(unsigned int c) const { return stages_[c]; }
+};
+
+#endif /* PARTSCHEDULE_HPP_ */
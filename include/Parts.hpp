@@ -166,6 +166,13 @@ public:
 		assert((*filterid_)[self_].size() > mixture);
 		return scores[(*filterid_)[self_][mixture]];
 	}
+	//! the part score, from a read-only vector of scores
+	const cv::Mat& score(const vectorMat& scores, unsigned int mixture = 0) const {
+		assert((*filterid_)[self_].size() > mixture);
+		return scores[(*filterid_)[self_][mixture]];
+	}
+	//! the index of the part's filter (and score) in the monolithic pool
+	int filterid(unsigned int mixture = 0) const { return (*filterid_)[self_][mixture]; }
 	//! the part's filter index
 	int filteri(unsigned int mixture = 0) const { return (*filtersi_)[(*filterid_)[self_][mixture]]; }
 	//! the part's bias
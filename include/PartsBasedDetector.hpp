@@ -42,9 +42,17 @@
 #include <vector>
 #include <opencv2/core/core.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include "Parts.hpp"
 #include "Model.hpp"
 #include "Candidate.hpp"
+#include "CandidateSet.hpp"
+#include "DetectionBudget.hpp"
+#include "DetectionExecutor.hpp"
+#include "DetectionRoi.hpp"
+#include "DetectionStats.hpp"
+#include "DetectionWorkspace.hpp"
 #include "IFeatures.hpp"
 #include "IConvolutionEngine.hpp"
 #include "DynamicProgram.hpp"
@@ -146,6 +154,11 @@
  * method distributeModel() for setting up the detector parameters from a deserialized
  * model, and a method detect() for running the detection pipeline.
  *
+ * detect() does not modify the detector, so one detector may serve any number of
+ * threads. The scratch state of each call lives in a DetectionWorkspace, either
+ * supplied by the caller or lent from the detector's own pool. The model and
+ * settings must not be changed while detect() is running.
+ *
  * @tparam T the detector precision. Should be one of float or double. On modern 64-bit
  * machines, the latter will likely be just as fast.
  */
@@ -157,20 +170,88 @@ private:
 	//! produces features, feature pyramids and compares features with Parts
 	boost::scoped_ptr<IFeatures> features_;
 	//! compares features with Parts
-	boost::scoped_ptr<IConvolutionEngine> convolution_engine_;
+	boost::shared_ptr<IConvolutionEngine> convolution_engine_;
 	//! dynamic program to predict part positions and candidate likelihoods from raw scores
 	DynamicProgram<T> dp_;
 	//! the tree of Parts
 	Parts parts_;
+	//! the storage the model's filters refer to, if they do not own their data
+	boost::shared_ptr<const void> model_storage_;
 	//! the search space pruner
 	SearchSpacePruning<T> ssp_;
+	//! the workspaces of detect() calls which do not supply their own
+	mutable DetectionWorkspacePool workspaces_;
+	//! runs detectAsync() requests, created on first use if not set. Shared, so that
+	//! a submission in flight keeps the executor alive if setExecutor() replaces it
+	mutable boost::shared_ptr<DetectionExecutor> executor_;
+	mutable boost::mutex executor_mutex_;
+	//! where the stats of each detection are written, if anywhere
+	boost::shared_ptr<IStatsSink> stats_sink_;
+	void detectPyramid(const vectorMat& pyramid, const vectorf& scales, const vectori& levels, CandidateSet& candidates,
+			DetectionWorkspace& workspace, DetectionStats* stats = NULL) const;
+	bool detectRequest(const cv::Mat& im, const cv::Mat& depth, DetectionRequest& request) const;
+	void detectImage(const cv::Mat& im, const cv::Mat& depth, CandidateSet& candidates, DetectionWorkspace& workspace, DetectionStats* stats) const;
+	void convolveLevels(const vectorMat& pyramid, vector2DMat& pdf, const vector2Di& mask, IConvolutionWorkspace& engine, DetectionStats* stats) const;
 public:
+	//! the number of detectAsync() requests the default executor runs concurrently
+	static const unsigned int DEFAULT_EXECUTOR_THREADS = 2;
+	//! the number of detectAsync() requests which may wait in the default executor (blocking when full)
+	static const unsigned int DEFAULT_EXECUTOR_CAPACITY = 8;
 	PartsBasedDetector() {}
 	virtual ~PartsBasedDetector() {}
 	// public methods
 	const std::string& name(void) const { return name_; }
-	void detect(const cv::Mat& im, std::vector<Candidate>& candidates);
-	void detect(const cv::Mat& im, const cv::Mat& depth, std::vector<Candidate>& candidates);
+	//! the feature pyramid of the model, for detectors built on the stages of detect()
+	const IFeatures& features(void) const { return *features_; }
+	//! the convolution engine holding the model's filters
+	boost::shared_ptr<const IConvolutionEngine> convolutionEngine(void) const { return convolution_engine_; }
+	//! the dynamic program of the model's part tree
+	const DynamicProgram<T>& dp(void) const { return dp_; }
+	/*! @brief backtrack on demand rather than storing the argmax maps
+	 *
+	 * @see DynamicProgram::setBacktrackOnDemand()
+	 */
+	void setBacktrackOnDemand(bool ondemand, int window = 5) { dp_.setBacktrackOnDemand(ondemand, window); }
+	/*! @brief make detect() return at most k detections, after non-maxima suppression
+	 *
+	 * The best k local maxima of the root scores are selected before any
+	 * part placements are recovered, so only k trees are backtracked
+	 *
+	 * @param k the number of detections to return, or 0 to return all
+	 * @see DynamicProgram::selectTopK()
+	 */
+	void setTopK(unsigned int k) { dp_.setTopK(k); }
+	/*! @brief write the stats of every detection to a sink
+	 *
+	 * Every overload of detect() and detectAsync() writes one record per
+	 * call: a batch is written as a single detection, and a cancelled
+	 * asynchronous detection is not written. Stats are not collected unless
+	 * a sink is set, or they are requested through
+	 * detect(const cv::Mat&, const cv::Mat&, CandidateSet&, DetectionStats&)
+	 *
+	 * @param sink the sink (for example a JsonLinesStatsSink), or an empty pointer to stop
+	 */
+	void setStatsSink(const boost::shared_ptr<IStatsSink>& sink) { stats_sink_ = sink; }
+	void setExecutor(unsigned int nthreads, unsigned int capacity, DropPolicy policy = DROP_NONE);
+	void detect(const cv::Mat& im, std::vector<Candidate>& candidates) const;
+	void detect(const cv::Mat& im, const cv::Mat& depth, std::vector<Candidate>& candidates) const;
+	void detect(const cv::Mat& im, CandidateSet& candidates) const;
+	void detect(const cv::Mat& im, const cv::Mat& depth, CandidateSet& candidates) const;
+	void detect(const cv::Mat& im, const cv::Mat& depth, CandidateSet& candidates, DetectionWorkspace& workspace) const;
+	void detect(const cv::Mat& im, const cv::Mat& depth, CandidateSet& candidates, DetectionStats& stats) const;
+	bool detect(const cv::Mat& im, const cv::Mat& depth, CandidateSet& candidates, const DetectionBudget& budget) const;
+	void detect(const cv::Mat& im, const std::vector<DetectionRoi>& rois, std::vector<Candidate>& candidates) const;
+	void detect(const cv::Mat& im, const std::vector<DetectionRoi>& rois, CandidateSet& candidates) const;
+	void detect(const std::vector<cv::Mat>& images, std::vector<vectorCandidate>& candidates) const;
+	void detect(const std::vector<cv::Mat>& images, std::vector<CandidateSet>& candidates) const;
+	DetectionFuture detectAsync(const cv::Mat& im, const cv::Mat& depth = cv::Mat(), const DetectionCallback& callback = DetectionCallback()) const;
+	// the stages of detect(), for pipelining
+	void pyramid(const cv::Mat& im, vectorMat& pyramid, vectorf& scales, DetectionStats* stats = NULL) const;
+	void convolve(const vectorMat& pyramid, vector2DMat& pdf) const;
+	void convolve(const vectorMat& pyramid, vector2DMat& pdf, DetectionWorkspace& workspace, DetectionStats* stats = NULL) const;
+	bool solve(vector2DMat& pdf, const vectorf& scales, const vectori& levels, CandidateSet& candidates,
+			const DetectionRequest* request = NULL, const Deadline& deadline = Deadline(), bool* complete = NULL,
+			DetectionStats* stats = NULL) const;
 	void distributeModel(Model& model);
 };
 
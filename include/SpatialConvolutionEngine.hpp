@@ -8,6 +8,7 @@
 #ifndef SPATIALCONVOLUTIONENGINE_HPP_
 #define SPATIALCONVOLUTIONENGINE_HPP_
 
+#include <boost/scoped_ptr.hpp>
 #include "IConvolutionEngine.hpp"
 
 class SpatialConvolutionEngine: public IConvolutionEngine {
@@ -16,14 +17,21 @@ private:
 	unsigned int flen_;
 	//! the internally supported convolution type, taken from the filter type
 	int type_;
-	//! the internal representation of the filters
-	vector2DFilterEngine filters_;
-	void convolve(const cv::Mat& feature, vectorFilterEngine& filter, cv::Mat& pdf, const unsigned int stride);
+	//! the channels of each filter, as separate planes
+	vector2DMat filters_;
+	//! the workspace used by the non-const pdf() methods
+	boost::scoped_ptr<IConvolutionWorkspace> workspace_;
+	void convolve(const cv::Mat& feature, vectorFilterEngine& filter, cv::Mat& pdf, const unsigned int stride) const;
 public:
 	SpatialConvolutionEngine(int type, unsigned int flen);
 	virtual ~SpatialConvolutionEngine();
 	virtual void setFilters(const vectorMat& filters);
+	virtual void compileFilters(const vectorMat& filters, vector2DMat& compiled) const;
+	virtual bool setCompiledFilters(const vector2DMat& compiled);
 	virtual void pdf(const vectorMat& features, vector2DMat& responses);
+	virtual void pdf(const vectorMat& features, vector2DMat& responses, const vector2Di& mask);
+	virtual void pdf(const vectorMat& features, vector2DMat& responses, const vector2Di& mask, IConvolutionWorkspace& workspace) const;
+	virtual IConvolutionWorkspace* createWorkspace(void) const;
 };
 
 #endif /* SPATIALCONVOLUTIONENGINE_HPP_ */
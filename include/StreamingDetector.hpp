@@ -0,0 +1,138 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    StreamingDetector.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef STREAMINGDETECTOR_HPP_
+#define STREAMINGDETECTOR_HPP_
+#include <string>
+#include <opencv2/core/core.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include "BoundedQueue.hpp"
+#include "CandidateSet.hpp"
+#include "PartsBasedDetector.hpp"
+#include "types.hpp"
+
+/*! @class StreamingDetector
+ *  @brief a pipelined detector for video streams
+ *
+ * StreamingDetector splits PartsBasedDetector::detect() into its three
+ * stages - the feature pyramid, the convolution with the part filters, and
+ * the dynamic program - and runs each in its own thread. While the dynamic
+ * program runs on frame t, the convolution runs on frame t+1 and the pyramid
+ * on frame t+2, so the very different parallel profiles of the stages
+ * overlap rather than leaving cores idle in turn.
+ *
+ * Stages are connected by queues holding at most depth frames. Frames are
+ * admitted with push(), according to the drop policy, and the candidates
+ * are retrieved in order with pop() or tryPop(). If the results are not
+ * retrieved, the pipeline fills and push() drops frames (or waits, with
+ * DROP_NONE).
+ *
+ * close() admits no more frames but lets those in flight finish, so that
+ * pop() returns false once they have all been retrieved. A frame on which
+ * detection fails (for example an image of an unsupported depth) is
+ * returned in order with no candidates and its error. stop() discards
+ * the frames in flight and joins the stage threads, after which start()
+ * may run the pipeline again.
+ *
+ * \code
+ * StreamingDetector<float> stream(pbd, 2, DROP_OLDEST);
+ * stream.start();
+ * while (capture.read(frame)) {
+ * 	stream.push(frame.clone());
+ * 	unsigned long id;
+ * 	Mat im;
+ * 	CandidateSet candidates;
+ * 	while (stream.tryPop(id, im, candidates)) visualize(im, candidates);
+ * }
+ * stream.stop();
+ * \endcode
+ */
+template<typename T>
+class StreamingDetector {
+private:
+	//! a frame in flight, and the intermediate results of each stage
+	struct Frame {
+		unsigned long id;
+		cv::Mat image;
+		vectorMat pyramid;
+		vectorf scales;
+		vector2DMat pdf;
+		CandidateSet candidates;
+		//! why a stage failed on the frame, or empty
+		std::string error;
+	};
+	typedef boost::shared_ptr<Frame> FramePtr;
+
+	//! the detector whose stages are pipelined
+	const PartsBasedDetector<T>& detector_;
+	//! the policy for admitting new frames
+	DropPolicy policy_;
+	//! the queues before, between and after the stages
+	BoundedQueue<FramePtr> input_, pyramids_, responses_, output_;
+	//! the stage threads, created by each start()
+	boost::scoped_ptr<boost::thread_group> threads_;
+	//! the id of the next frame pushed
+	unsigned long next_;
+	//! the number of frames dropped
+	unsigned long dropped_;
+	boost::mutex mutex_;
+	bool running_;
+
+	static void forward(BoundedQueue<FramePtr>& queue, const FramePtr& frame);
+	static void fail(Frame& frame, const std::string& error);
+	static void retrieve(const FramePtr& frame, unsigned long& id, cv::Mat& image, CandidateSet& candidates, std::string* error);
+
+	void pyramidStage(void);
+	void convolveStage(void);
+	void solveStage(void);
+public:
+	StreamingDetector(const PartsBasedDetector<T>& detector, unsigned int depth = 2, DropPolicy policy = DROP_OLDEST);
+	virtual ~StreamingDetector() { stop(); }
+	void start(void);
+	void close(void);
+	void stop(void);
+	bool push(const cv::Mat& image);
+	bool pop(unsigned long& id, cv::Mat& image, CandidateSet& candidates, std::string* error = NULL);
+	bool tryPop(unsigned long& id, cv::Mat& image, CandidateSet& candidates, std::string* error = NULL);
+	//! the number of frames dropped so far
+	unsigned long dropped(void) { boost::lock_guard<boost::mutex> lock(mutex_); return dropped_; }
+};
+
+#endif /* STREAMINGDETECTOR_HPP_ */
@@ -0,0 +1,93 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    Trace.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef TRACE_HPP_
+#define TRACE_HPP_
+#include <string>
+#include <opencv2/core/core.hpp>
+
+/*! @class Trace
+ *  @brief a collector of timed spans, written as Chrome trace events
+ *
+ * Spans are recorded into a buffer owned by the recording thread, so
+ * threads never contend while detecting. The buffers are merged when the
+ * trace is written, which must not overlap with detection. The output
+ * loads in chrome://tracing and Perfetto, with one track per thread, so
+ * gaps and imbalance between the threads of each parallel loop are visible
+ *
+ * Spans are only recorded when building WITH_TRACING. Otherwise the
+ * TRACE_SPAN macros expand to nothing, and the trace is always empty
+ */
+class Trace {
+public:
+	//! whether spans are recorded in this build
+	static bool enabled(void);
+	//! the current time, in ticks
+	static int64 now(void) { return cv::getTickCount(); }
+	static void record(const char* name, int level, int64 begin, int64 end);
+	static void clear(void);
+	static bool write(const std::string& path);
+};
+
+/*! @class TraceSpan
+ *  @brief records the lifetime of a scope as a span of the trace
+ *
+ * The name must outlive the trace (normally it is a string literal)
+ */
+class TraceSpan {
+private:
+	const char* name_;
+	int level_;
+	int64 begin_;
+public:
+	explicit TraceSpan(const char* name, int level = -1) : name_(name), level_(level), begin_(Trace::now()) {}
+	~TraceSpan() { Trace::record(name_, level_, begin_, Trace::now()); }
+};
+
+#define TRACE_CONCAT_(a, b) a ## b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#ifdef WITH_TRACING
+//! trace the enclosing scope
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(trace_span_, __LINE__)(name)
+//! trace the enclosing scope, as the work of one pyramid level
+#define TRACE_SPAN_LEVEL(name, level) TraceSpan TRACE_CONCAT(trace_span_, __LINE__)(name, level)
+#else
+#define TRACE_SPAN(name)
+#define TRACE_SPAN_LEVEL(name, level)
+#endif
+
+#endif /* TRACE_HPP_ */
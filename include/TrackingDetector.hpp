@@ -0,0 +1,138 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    TrackingDetector.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef TRACKINGDETECTOR_HPP_
+#define TRACKINGDETECTOR_HPP_
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <opencv2/video/tracking.hpp>
+#include "CandidateSet.hpp"
+#include "DetectionRoi.hpp"
+#include "PartsBasedDetector.hpp"
+#include "types.hpp"
+
+/*! @class TrackingDetector
+ *  @brief tracking-by-detection over a video, searching only where objects are expected
+ *
+ * TrackingDetector keeps a track of each object it has detected: a constant
+ * velocity Kalman filter over the centre, width and height of its bounding box.
+ * Every cadence frames the whole frame is searched, to find new objects.
+ * Between full scans, each track predicts where its object will be in the next
+ * frame, and only those regions are searched (see
+ * PartsBasedDetector::detect(const cv::Mat&, const std::vector<DetectionRoi>&, CandidateSet&)),
+ * at the scales within a factor of the object's last scale.
+ *
+ * The candidates of each frame are first suppressed by their overlap with
+ * each other, so that an object found at several levels or by several
+ * mixtures is one detection. Detections are then assigned to tracks
+ * greedily by intersection over union. Unassigned detections start new
+ * tracks, tracks which go unassigned for more than a number of frames are
+ * dropped, and a track which overlaps a longer established one is merged
+ * into it. The regions of tracks which intersect are searched as one
+ *
+ * \code
+ * TrackingDetector<float> tracker(pbd, 10);
+ * while (capture.read(frame)) {
+ * 	CandidateSet candidates;
+ * 	tracker.detect(frame, candidates);
+ * 	const std::vector<TrackingDetector<float>::Track>& tracks = tracker.tracks();
+ * }
+ * \endcode
+ */
+template<typename T>
+class TrackingDetector {
+public:
+	//! the state of a tracked object
+	struct Track {
+		//! a unique identifier of the track
+		unsigned int id;
+		//! the bounding box, predicted if the object was not detected in the last frame
+		cv::Rect box;
+		//! the score of the last detection
+		float score;
+		//! the model component of the last detection
+		int component;
+		//! the number of frames in which the object was detected
+		unsigned int hits;
+		//! the number of consecutive frames in which the object was not detected
+		unsigned int misses;
+	};
+private:
+	//! the detector whose model is used
+	const PartsBasedDetector<T>& detector_;
+	//! the number of frames between full scans
+	unsigned int cadence_;
+	//! the overlap at which a detection is assigned to a track, and tracks are merged
+	float overlap_;
+	//! the overlap above which the weaker of two candidates of a frame is suppressed
+	float suppression_;
+	//! the number of consecutive misses after which a track is dropped
+	unsigned int maxmisses_;
+	//! the fraction of the predicted box by which it is padded on each side
+	float margin_;
+	//! the factor about the scale of a track which is searched
+	float scalefactor_;
+	//! the number of frames seen
+	unsigned int frame_;
+	//! the identifier of the next track
+	unsigned int nextid_;
+	//! whether the last frame was scanned in full
+	bool scanned_;
+	//! the tracks
+	std::vector<Track> tracks_;
+	//! the Kalman filter of each track
+	std::vector<cv::KalmanFilter> filters_;
+	void predict(void);
+	void assign(const CandidateSet& candidates);
+	void merge(void);
+	float scale(const Track& track) const;
+public:
+	TrackingDetector(const PartsBasedDetector<T>& detector, unsigned int cadence = 10, float overlap = 0.3f,
+			unsigned int maxmisses = 3, float margin = 0.5f, float scalefactor = 1.25f, float suppression = 0.3f) :
+		detector_(detector), cadence_(cadence), overlap_(overlap), suppression_(suppression), maxmisses_(maxmisses),
+		margin_(margin), scalefactor_(scalefactor), frame_(0), nextid_(0), scanned_(false) {}
+	virtual ~TrackingDetector() {}
+	void detect(const cv::Mat& im, CandidateSet& candidates);
+	//! the current tracks
+	const std::vector<Track>& tracks(void) const { return tracks_; }
+	//! whether the last call to detect() searched the whole frame
+	bool scanned(void) const { return scanned_; }
+	//! drop all tracks, so that the next frame is searched in full
+	void reset(void) { tracks_.clear(); filters_.clear(); frame_ = 0; }
+};
+
+#endif /* TRACKINGDETECTOR_HPP_ */
@@ -38,8 +38,39 @@
 
 #ifndef NMS_HPP_
 #define NMS_HPP_
+#include <limits>
+#include <vector>
 #include <opencv2/core/core.hpp>
+
+//! the measure of overlap between two boxes
+enum OverlapCriterion {
+	//! intersection over union
+	OVERLAP_IOU,
+	//! intersection over the area of the smaller box
+	OVERLAP_MIN
+};
+
+//! the decay applied to the scores of overlapping boxes by softNonMaximaSuppression()
+enum SoftSuppression {
+	//! decay by one minus the IoU, above an IoU threshold
+	SOFT_LINEAR,
+	//! decay by a gaussian of the IoU
+	SOFT_GAUSSIAN
+};
+
 void nonMaximaSuppression(const cv::Mat& src, const int sz, cv::Mat& dst, const cv::Mat mask=cv::Mat());
+void nonMaximaSuppression(const std::vector<cv::Mat>& src, const std::vector<int>& sz, std::vector<cv::Mat>& dst,
+		const std::vector<cv::Mat>& mask=std::vector<cv::Mat>());
+void nonMaximaSuppression(const std::vector<cv::Rect>& boxes, const std::vector<float>& scores, const float overlap,
+		std::vector<unsigned int>& keep, const OverlapCriterion criterion=OVERLAP_IOU, const unsigned int K=0);
+float boxOverlap(const cv::Rect& r1, const cv::Rect& r2, const OverlapCriterion criterion=OVERLAP_IOU);
+void softNonMaximaSuppression(const std::vector<cv::Rect>& boxes, std::vector<float>& scores, std::vector<unsigned int>& keep,
+		const SoftSuppression method=SOFT_GAUSSIAN, const float overlap=0.3f, const float sigma=0.5f,
+		const float thresh=-std::numeric_limits<float>::infinity());
+void fusionWeights(const std::vector<float>& scores, std::vector<float>& weights);
+cv::Rect fuseBoxes(const std::vector<cv::Rect>& boxes, const std::vector<float>& weights);
+void clusterBoxes(const std::vector<cv::Rect>& boxes, const std::vector<float>& weights, const float overlap,
+		std::vector<std::vector<unsigned int> >& clusters, std::vector<cv::Rect>& fused, const std::vector<int>& labels=std::vector<int>());
 
 
 #endif /* NMS_HPP_ */
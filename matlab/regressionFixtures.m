@@ -0,0 +1,82 @@
+function regressionFixtures(outdir)
+% Write the outputs of the mex files as fixtures for the C++ regression tests
+%
+% regressionFixtures(outdir) writes features.yml, fconv.yml, dt.yml and
+% shiftdt.yml to outdir (by default ../test/regression/fixtures). The files
+% are OpenCV YAML, with matrices stored row-major, multichannel features
+% interleaved along each row, and indices converted to start from 0, so
+% they can be read directly with cv::FileStorage
+
+if nargin < 1
+  outdir = '../test/regression/fixtures';
+end
+globals;
+rand('seed', 7);
+randn('seed', 7);
+
+% features.cc
+im = uint8(255*rand(96, 128, 3));
+sbin = 4;
+feat = features(double(im), sbin);
+fid = fopen(fullfile(outdir, 'features.yml'), 'w');
+fprintf(fid, '%%YAML:1.0\n');
+writemat(fid, 'image', im(:,:,[3 2 1]));
+fprintf(fid, 'sbin: %d\n', sbin);
+writemat(fid, 'features', single(feat));
+fclose(fid);
+
+% fconv.cc
+A = randn(17, 23, 32);
+B = 0.1*randn(5, 6, 32);
+C = fconv(A, {B}, 1, 1);
+fid = fopen(fullfile(outdir, 'fconv.yml'), 'w');
+fprintf(fid, '%%YAML:1.0\n');
+writemat(fid, 'features', single(A));
+writemat(fid, 'filter', single(B));
+fprintf(fid, 'flen: %d\n', size(A, 3));
+writemat(fid, 'response', single(C{1}));
+fclose(fid);
+
+% dt.cc and shiftdt.cc, with the offsets converted to start from 0
+names = {'dt', 'shiftdt'};
+offsets = [1 1; 3 0];
+for n = 1:2
+  vals = randn(13, 17);
+  w = [0.01 0.02 0.03 -0.02];
+  off = offsets(n,:);
+  if n == 1
+    [M, Ix, Iy] = dt(vals, w(1), w(2), w(3), w(4), off(1), off(2), size(vals, 2), size(vals, 1), 1);
+  else
+    [M, Ix, Iy] = shiftdt(vals, w(1), w(2), w(3), w(4), off(1), off(2), size(vals, 2), size(vals, 1), 1);
+  end
+  fid = fopen(fullfile(outdir, [names{n} '.yml']), 'w');
+  fprintf(fid, '%%YAML:1.0\n');
+  writemat(fid, 'scores', vals);
+  writemat(fid, 'w', w);
+  writemat(fid, 'offset', int32(off - 1));
+  writemat(fid, 'out', M);
+  writemat(fid, 'Ix', int32(Ix - 1));
+  writemat(fid, 'Iy', int32(Iy - 1));
+  fclose(fid);
+end
+
+
+function writemat(fid, name, A)
+% write an array as an OpenCV YAML matrix, interleaving the third dimension
+[h, w, k] = size(A);
+switch class(A)
+  case 'uint8',  dt = 'u'; fmt = '%d';
+  case 'int32',  dt = 'i'; fmt = '%d';
+  case 'single', dt = 'f'; fmt = '%.9g';
+  otherwise,     dt = 'd'; fmt = '%.17g';
+end
+if strcmp(dt, 'u')
+  dt = sprintf('"%du"', k);
+  cols = w;
+else
+  cols = w*k;
+end
+data = reshape(permute(double(A), [3 2 1]), 1, []);
+fprintf(fid, '%s: !!opencv-matrix\n   rows: %d\n   cols: %d\n   dt: %s\n   data: [ ', name, h, cols, dt);
+fprintf(fid, [fmt ', '], data(1:end-1));
+fprintf(fid, [fmt ' ]\n'], data(end));
@@ -0,0 +1,387 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    BinaryModel.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include "BinaryModel.hpp"
+using namespace std;
+using namespace cv;
+
+namespace {
+
+//! the identifying bytes at the start of every file
+const char MAGIC[4] = {'P', 'B', 'D', 'M'};
+//! written in native byte order, so files from a machine of the other order are rejected
+const uint32_t BYTEORDER = 0x01020304;
+//! the alignment of each matrix within the file
+const size_t ALIGNMENT = 64;
+
+/*! @class BinaryWriter
+ *  @brief appends values and arrays to a buffer in native byte order
+ */
+class BinaryWriter {
+private:
+	vector<char> buffer_;
+public:
+	template<typename V> void write(const V& value) {
+		const char* bytes = reinterpret_cast<const char*>(&value);
+		buffer_.insert(buffer_.end(), bytes, bytes + sizeof(V));
+	}
+	void write(const void* data, size_t bytes) {
+		const char* begin = static_cast<const char*>(data);
+		buffer_.insert(buffer_.end(), begin, begin + bytes);
+	}
+	void align(size_t alignment) { buffer_.resize((buffer_.size() + alignment - 1) / alignment * alignment, 0); }
+	//! a count, followed by the elements
+	template<typename V> void array(const vector<V>& values) {
+		write<uint32_t>(values.size());
+		if (!values.empty()) write(&values[0], values.size() * sizeof(V));
+	}
+	//! the offset of each inner vector, then the concatenated elements
+	template<typename V> void array(const vector<vector<V> >& values) {
+		vector<uint32_t> offsets(1, 0);
+		vector<V> flat;
+		for (unsigned int n = 0; n < values.size(); ++n) {
+			flat.insert(flat.end(), values[n].begin(), values[n].end());
+			offsets.push_back(flat.size());
+		}
+		array(offsets);
+		array(flat);
+	}
+	//! the offset of each inner vector, then the concatenated 2D vectors
+	template<typename V> void array(const vector<vector<vector<V> > >& values) {
+		vector<uint32_t> offsets(1, 0);
+		vector<vector<V> > flat;
+		for (unsigned int n = 0; n < values.size(); ++n) {
+			flat.insert(flat.end(), values[n].begin(), values[n].end());
+			offsets.push_back(flat.size());
+		}
+		array(offsets);
+		array(flat);
+	}
+	void text(const string& str) {
+		write<uint32_t>(str.size());
+		write(str.data(), str.size());
+	}
+	bool save(const string& filename) const {
+		ofstream file(filename.c_str(), ios::out | ios::binary | ios::trunc);
+		file.write(&buffer_[0], buffer_.size());
+		return file.good();
+	}
+};
+
+/*! @class BinaryReader
+ *  @brief reads the values and arrays of a BinaryWriter back from memory
+ *
+ * Every read is bounds checked, and fails (returning false) past the end
+ */
+class BinaryReader {
+private:
+	const char* begin_;
+	const char* end_;
+	const char* pos_;
+public:
+	BinaryReader(const char* begin, size_t size) : begin_(begin), end_(begin + size), pos_(begin) {}
+	template<typename V> bool read(V& value) {
+		if ((size_t)(end_ - pos_) < sizeof(V)) return false;
+		memcpy(&value, pos_, sizeof(V));
+		pos_ += sizeof(V);
+		return true;
+	}
+	//! the address of the next bytes, without copying them
+	const char* data(size_t bytes) {
+		if ((size_t)(end_ - pos_) < bytes) return NULL;
+		const char* data = pos_;
+		pos_ += bytes;
+		return data;
+	}
+	bool align(size_t alignment) {
+		const size_t offset = (pos_ - begin_ + alignment - 1) / alignment * alignment;
+		if (offset > (size_t)(end_ - begin_)) return false;
+		pos_ = begin_ + offset;
+		return true;
+	}
+	template<typename V> bool array(vector<V>& values) {
+		uint32_t n;
+		if (!read(n)) return false;
+		const char* data = this->data((size_t)n * sizeof(V));
+		if (!data) return false;
+		values.resize(n);
+		if (n) memcpy(&values[0], data, (size_t)n * sizeof(V));
+		return true;
+	}
+	template<typename V> bool array(vector<vector<V> >& values) {
+		vector<uint32_t> offsets;
+		vector<V> flat;
+		if (!array(offsets) || !array(flat) || !nested(offsets, flat.size())) return false;
+		values.resize(offsets.size() - 1);
+		for (unsigned int n = 0; n < values.size(); ++n) {
+			values[n].assign(flat.begin() + offsets[n], flat.begin() + offsets[n+1]);
+		}
+		return true;
+	}
+	template<typename V> bool array(vector<vector<vector<V> > >& values) {
+		vector<uint32_t> offsets;
+		vector<vector<V> > flat;
+		if (!array(offsets) || !array(flat) || !nested(offsets, flat.size())) return false;
+		values.resize(offsets.size() - 1);
+		for (unsigned int n = 0; n < values.size(); ++n) {
+			values[n].assign(flat.begin() + offsets[n], flat.begin() + offsets[n+1]);
+		}
+		return true;
+	}
+	bool text(string& str) {
+		uint32_t n;
+		if (!read(n)) return false;
+		const char* data = this->data(n);
+		if (!data) return false;
+		str.assign(data, n);
+		return true;
+	}
+private:
+	//! whether offsets start at 0 and increase to the number of elements
+	static bool nested(const vector<uint32_t>& offsets, size_t size) {
+		if (offsets.empty() || offsets.front() != 0 || offsets.back() != size) return false;
+		for (unsigned int n = 1; n < offsets.size(); ++n) {
+			if (offsets[n] < offsets[n-1]) return false;
+		}
+		return true;
+	}
+};
+
+//! write a matrix, aligned, in the given precision
+void writeMat(BinaryWriter& writer, const Mat& mat, int depth) {
+	Mat converted;
+	mat.reshape(1).convertTo(converted, depth);
+	if (!converted.isContinuous()) converted = converted.clone();
+	writer.write<int32_t>(converted.rows);
+	writer.write<int32_t>(converted.cols);
+	writer.write<int32_t>(mat.channels());
+	writer.align(ALIGNMENT);
+	writer.write(converted.data, converted.total() * converted.elemSize());
+}
+
+//! refer to a matrix written by writeMat(), without copying it
+bool readMat(BinaryReader& reader, int depth, Mat& mat) {
+	int32_t rows, cols, channels;
+	if (!reader.read(rows) || !reader.read(cols) || !reader.read(channels) || !reader.align(ALIGNMENT)) return false;
+	if (rows < 0 || cols < 0 || channels <= 0 || cols % channels) return false;
+	const char* data = reader.data((size_t)rows * cols * (depth == CV_32F ? sizeof(float) : sizeof(double)));
+	if (!data) return false;
+	// the mapping is copy-on-write, so the matrix may safely be written to
+	mat = Mat(rows, cols, CV_MAKETYPE(depth, 1), const_cast<char*>(data)).reshape(channels);
+	return true;
+}
+
+}
+
+/*! @brief write the model in the binary format
+ *
+ * The filters are converted to the precision given at construction
+ *
+ * @param filename the path of the file
+ * @return true if the file was written
+ */
+bool BinaryModel::serialize(const string& filename) const {
+
+	if (depth_ != CV_32F && depth_ != CV_64F) return false;
+	BinaryWriter writer;
+
+	// write the header and the primitives
+	writer.write(MAGIC, sizeof(MAGIC));
+	writer.write<uint32_t>(BYTEORDER);
+	writer.write<uint32_t>(VERSION);
+	writer.write<int32_t>(depth_);
+	writer.write<int32_t>(nscales_);
+	writer.write<float>(thresh_);
+	writer.write<int32_t>(binsize_);
+	writer.write<int32_t>(norient_);
+	writer.write<int32_t>(flen_);
+	writer.text(name_);
+
+	// write the filters, then their compiled layout (if any), each aligned
+	writer.write<uint32_t>(filtersw_.size());
+	for (unsigned int n = 0; n < filtersw_.size(); ++n) writeMat(writer, filtersw_[n], depth_);
+	writer.write<uint32_t>(compiled_.size());
+	for (unsigned int n = 0; n < compiled_.size(); ++n) {
+		writer.write<uint32_t>(compiled_[n].size());
+		for (unsigned int c = 0; c < compiled_[n].size(); ++c) writeMat(writer, compiled_[n][c], depth_);
+	}
+
+	// write the weights and index tables
+	vectori anchors;
+	for (unsigned int n = 0; n < anchors_.size(); ++n) {
+		anchors.push_back(anchors_[n].x);
+		anchors.push_back(anchors_[n].y);
+	}
+	writer.array(filtersi_);
+	writer.array(defw_);
+	writer.array(defi_);
+	writer.array(biasw_);
+	writer.array(biasi_);
+	writer.array(anchors);
+	writer.array(biasid_);
+	writer.array(filterid_);
+	writer.array(defid_);
+	writer.array(parentid_);
+	writer.array(cascadethresh_);
+	writer.array(cascadeorder_);
+	return writer.save(filename);
+}
+
+/*! @brief map a model in the binary format
+ *
+ * The filters refer into a private, copy-on-write mapping, which is held by
+ * storage(). Writing to a filter copies its page, and never changes the file
+ *
+ * @param filename the path of the file
+ * @return false if the file could not be mapped, is of a later version or
+ * another byte order, is truncated, or its parameters are inconsistent
+ * (see Model::validate())
+ */
+bool BinaryModel::deserialize(const string& filename) {
+
+	// map the file copy-on-write, so the filters may be modified in place without touching the file
+	boost::shared_ptr<boost::interprocess::mapped_region> region;
+	try {
+		boost::interprocess::file_mapping file(filename.c_str(), boost::interprocess::read_only);
+		region.reset(new boost::interprocess::mapped_region(file, boost::interprocess::copy_on_write));
+	} catch (const boost::interprocess::interprocess_exception&) {
+		return false;
+	}
+	BinaryReader reader(static_cast<const char*>(region->get_address()), region->get_size());
+
+	// read the header and the primitives
+	char magic[sizeof(MAGIC)];
+	uint32_t byteorder, version;
+	int32_t depth, nscales, binsize, norient, flen;
+	float thresh;
+	string name;
+	for (unsigned int n = 0; n < sizeof(MAGIC); ++n) {
+		if (!reader.read(magic[n]) || magic[n] != MAGIC[n]) return false;
+	}
+	if (!reader.read(byteorder) || byteorder != BYTEORDER) return false;
+	if (!reader.read(version) || version < 1 || version > VERSION) return false;
+	if (!reader.read(depth) || (depth != CV_32F && depth != CV_64F)) return false;
+	if (!reader.read(nscales) || !reader.read(thresh) || !reader.read(binsize) ||
+		!reader.read(norient) || !reader.read(flen) || !reader.text(name)) return false;
+
+	// refer to the filters and their compiled layout within the mapping
+	// (version 1 files have no compiled layout)
+	uint32_t nfilters, ncompiled = 0;
+	if (!reader.read(nfilters)) return false;
+	vectorMat filters(nfilters);
+	for (unsigned int n = 0; n < nfilters; ++n) {
+		if (!readMat(reader, depth, filters[n])) return false;
+	}
+	if (version >= 2 && !reader.read(ncompiled)) return false;
+	vector2DMat compiled(ncompiled);
+	for (unsigned int n = 0; n < ncompiled; ++n) {
+		uint32_t nplanes;
+		if (!reader.read(nplanes)) return false;
+		compiled[n].resize(nplanes);
+		for (unsigned int c = 0; c < nplanes; ++c) {
+			if (!readMat(reader, depth, compiled[n][c])) return false;
+		}
+	}
+
+	// read the weights and index tables
+	vectori anchors;
+	vectori filtersi, defi, biasi;
+	vector2Df defw, cascadethresh;
+	vectorf biasw;
+	vector3Di biasid, filterid, defid;
+	vector2Di parentid, cascadeorder;
+	if (!reader.array(filtersi) || !reader.array(defw) || !reader.array(defi) || !reader.array(biasw) ||
+		!reader.array(biasi) || !reader.array(anchors) || !reader.array(biasid) || !reader.array(filterid) ||
+		!reader.array(defid) || !reader.array(parentid) || !reader.array(cascadethresh) ||
+		!reader.array(cascadeorder) || anchors.size() % 2) return false;
+
+	// the file is complete, so check the parameters are consistent before replacing the model
+	BinaryModel loaded(depth);
+	loaded.name_ = name;
+	loaded.nscales_ = nscales;
+	loaded.thresh_ = thresh;
+	loaded.binsize_ = binsize;
+	loaded.norient_ = norient;
+	loaded.flen_ = flen;
+	loaded.filtersw_.swap(filters);
+	loaded.compiled_.swap(compiled);
+	loaded.filtersi_.swap(filtersi);
+	loaded.defw_.swap(defw);
+	loaded.defi_.swap(defi);
+	loaded.biasw_.swap(biasw);
+	loaded.biasi_.swap(biasi);
+	loaded.anchors_.resize(anchors.size() / 2);
+	for (unsigned int n = 0; n < loaded.anchors_.size(); ++n) loaded.anchors_[n] = Point(anchors[2*n], anchors[2*n+1]);
+	loaded.biasid_.swap(biasid);
+	loaded.filterid_.swap(filterid);
+	loaded.defid_.swap(defid);
+	loaded.parentid_.swap(parentid);
+	loaded.cascadethresh_.swap(cascadethresh);
+	loaded.cascadeorder_.swap(cascadeorder);
+	string problem;
+	if (!loaded.validate(problem)) return false;
+
+	name_ = loaded.name_;
+	nscales_ = nscales;
+	thresh_ = thresh;
+	binsize_ = binsize;
+	norient_ = norient;
+	flen_ = flen;
+	depth_ = depth;
+	filtersw_.swap(loaded.filtersw_);
+	compiled_.swap(loaded.compiled_);
+	filtersi_.swap(loaded.filtersi_);
+	defw_.swap(loaded.defw_);
+	defi_.swap(loaded.defi_);
+	biasw_.swap(loaded.biasw_);
+	biasi_.swap(loaded.biasi_);
+	anchors_.swap(loaded.anchors_);
+	biasid_.swap(loaded.biasid_);
+	filterid_.swap(loaded.filterid_);
+	defid_.swap(loaded.defid_);
+	parentid_.swap(loaded.parentid_);
+	cascadethresh_.swap(loaded.cascadethresh_);
+	cascadeorder_.swap(loaded.cascadeorder_);
+	storage_ = region;
+	return true;
+}
@@ -0,0 +1,199 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    CascadeCalibration.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include <cstdio>
+#include <limits>
+#include <algorithm>
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include "FileStorageModel.hpp"
+#include "HOGFeatures.hpp"
+#include "SpatialConvolutionEngine.hpp"
+#include "DynamicProgram.hpp"
+#include "Parts.hpp"
+#include "types.hpp"
+using namespace cv;
+using namespace std;
+
+/*! @brief collect the partial scores of the best detection in each image
+ *
+ * Each image is assumed to contain at least one instance of the object, so
+ * the best detection above the model threshold is taken as a positive. The
+ * partial root scores after each stage of the cascade are recorded at its
+ * root location
+ *
+ * @param images the list of positive image filenames
+ * @param features the feature engine
+ * @param engine the convolution engine
+ * @param parts the tree of Parts
+ * @param dp the dynamic program, with the cascade order of interest
+ * @param thresh the model threshold
+ * @param samples the partial scores of each positive, per component
+ */
+static void collect(const vector<string>& images, HOGFeatures<float>& features, SpatialConvolutionEngine& engine,
+		Parts& parts, DynamicProgram<float>& dp, float thresh, vector<vector2Df>& samples) {
+
+	samples.clear();
+	samples.resize(parts.ncomponents());
+	for (unsigned int i = 0; i < images.size(); ++i) {
+		Mat im = imread(images[i]);
+		if (im.empty()) {
+			printf("Skipping %s: image not found or invalid image format\n", images[i].c_str());
+			continue;
+		}
+
+		vectorMat pyramid;
+		vectorf scales;
+		vector2DMat pdf, rootv, rooti;
+		vector3DMat stages;
+		features.pyramid(im, pyramid, scales);
+		engine.pdf(pyramid, pdf);
+		dp.stageScores(pdf, stages, rootv, rooti);
+
+		// find the best detection across scale and component
+		double best = thresh;
+		int bn = -1, bc = -1;
+		Point bloc;
+		for (unsigned int n = 0; n < rootv.size(); ++n) {
+			for (unsigned int c = 0; c < rootv[n].size(); ++c) {
+				double maxv;
+				Point maxloc;
+				minMaxLoc(rootv[n][c], NULL, &maxv, NULL, &maxloc);
+				if (maxv > best) { best = maxv; bn = n; bc = c; bloc = maxloc; }
+			}
+		}
+		if (bn < 0) {
+			printf("Skipping %s: no detection above threshold\n", images[i].c_str());
+			continue;
+		}
+
+		vectorf partial;
+		for (unsigned int s = 0; s < stages[bn][bc].size(); ++s) {
+			partial.push_back(stages[bn][bc][s].at<float>(bloc));
+		}
+		samples[bc].push_back(partial);
+	}
+}
+
+/*! @brief comparator for ordering subtrees by their mean contribution */
+static bool contributes(const pair<float, int>& a, const pair<float, int>& b) { return a.first > b.first; }
+
+int main(int argc, char** argv) {
+
+	// check arguments
+	if (argc < 4) {
+		printf("Usage: CascadeCalibration model_file output_model_file image_file [image_file ...]\n");
+		exit(-1);
+	}
+
+	FileStorageModel model;
+	if (!model.deserialize(argv[1])) {
+		printf("Error deserializing file\n");
+		exit(-3);
+	}
+	vector<string> images(argv+3, argv+argc);
+
+	// setup the detection pipeline (see PartsBasedDetector::distributeModel())
+	HOGFeatures<float> features(model.binsize(), model.nscales(), model.flen(), model.norient());
+	SpatialConvolutionEngine engine(DataType<float>::type, model.flen());
+	for (unsigned int n = 0; n < model.filters().size(); ++n) {
+		model.filters()[n].convertTo(model.filters()[n], DataType<float>::type);
+	}
+	engine.setFilters(model.filters());
+	Parts parts(model.filters(), model.filtersi(), model.def(), model.defi(), model.bias(), model.biasi(),
+			model.anchors(), model.biasid(), model.filterid(), model.defid(), model.parentid());
+	DynamicProgram<float> dp(model.thresh());
+	dp.compile(parts);
+
+	// evaluate the root's subtrees in their natural order, without discarding anything
+	const unsigned int ncomponents = parts.ncomponents();
+	const float ninf = -numeric_limits<float>::infinity();
+	vector2Di order(ncomponents);
+	vector2Df thresh(ncomponents);
+	for (unsigned int c = 0; c < ncomponents; ++c) {
+		for (unsigned int p = 1; p < parts.nparts(c); ++p) {
+			if (parts.component(c, p).parent().self() == 0) order[c].push_back(p);
+		}
+		thresh[c].assign(order[c].size()+1, ninf);
+	}
+	dp.setCascade(thresh, order);
+
+	printf("collecting the contribution of each subtree...\n");
+	vector<vector2Df> samples;
+	collect(images, features, engine, parts, dp, model.thresh(), samples);
+
+	// order the subtrees by their mean contribution to the positives, most informative first
+	for (unsigned int c = 0; c < ncomponents; ++c) {
+		const unsigned int npositives = samples[c].size();
+		if (npositives == 0) continue;
+		vector<pair<float, int> > contribution;
+		for (unsigned int s = 0; s < order[c].size(); ++s) {
+			float sum = 0;
+			for (unsigned int i = 0; i < npositives; ++i) sum += samples[c][i][s+1] - samples[c][i][s];
+			contribution.push_back(make_pair(sum / npositives, order[c][s]));
+		}
+		std::stable_sort(contribution.begin(), contribution.end(), contributes);
+		for (unsigned int s = 0; s < order[c].size(); ++s) order[c][s] = contribution[s].second;
+	}
+	dp.setCascade(thresh, order);
+
+	// the threshold of each stage is the lowest partial score of any positive
+	printf("calibrating the stage thresholds...\n");
+	collect(images, features, engine, parts, dp, model.thresh(), samples);
+	for (unsigned int c = 0; c < ncomponents; ++c) {
+		const unsigned int npositives = samples[c].size();
+		if (npositives == 0) {
+			// no positives for this component, so it cannot be cascaded
+			thresh[c].clear();
+			order[c].clear();
+			continue;
+		}
+		for (unsigned int s = 0; s < thresh[c].size(); ++s) {
+			thresh[c][s] = numeric_limits<float>::infinity();
+			for (unsigned int i = 0; i < npositives; ++i) thresh[c][s] = std::min(thresh[c][s], samples[c][i][s]);
+		}
+		printf("component %d: %d positives, %ld stages\n", c, npositives, thresh[c].size());
+	}
+
+	model.cascadeThresh() = thresh;
+	model.cascadeOrder()  = order;
+	if (!model.serialize(argv[2])) {
+		printf("Error serializing file\n");
+		exit(-3);
+	}
+	return 0;
+}
@@ -0,0 +1,239 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DetectionExecutor.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include "DetectionExecutor.hpp"
+#include <exception>
+#include <opencv2/core/core.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+using namespace std;
+
+// ---------------------------------------------------------------------------
+// REQUEST
+// ---------------------------------------------------------------------------
+
+/*! @brief record the final status of a request and notify its waiters
+ *
+ * The callback runs on the calling thread, after the waiters are woken.
+ * Any exception it throws is discarded
+ *
+ * @param status the final status
+ * @param error the reason for a failure
+ */
+void DetectionRequest::finish(DetectionStatus status, const string& error) {
+	DetectionCallback callback;
+	{
+		boost::mutex::scoped_lock lock(mutex_);
+		status_ = status;
+		error_  = error;
+		task_.clear();
+		callback.swap(callback_);
+		finished_.notify_all();
+	}
+	if (!callback) return;
+	// the request has already finished, so a failing callback has nowhere to report to
+	try {
+		callback(DetectionFuture(shared_from_this()));
+	} catch (...) {}
+}
+
+// ---------------------------------------------------------------------------
+// FUTURE
+// ---------------------------------------------------------------------------
+
+static bool terminal(DetectionStatus status) {
+	return status != DETECTION_PENDING && status != DETECTION_RUNNING;
+}
+
+//! the shared state of the detection, raising an error if there is none
+DetectionRequest& DetectionFuture::state(void) const {
+	if (!request_) CV_Error(CV_StsNullPtr, "the future does not refer to a detection");
+	return *request_;
+}
+
+//! the current state of the detection
+DetectionStatus DetectionFuture::status(void) const {
+	DetectionRequest& request = state();
+	boost::mutex::scoped_lock lock(request.mutex_);
+	return request.status_;
+}
+
+//! has the detection finished, successfully or not
+bool DetectionFuture::ready(void) const {
+	return terminal(status());
+}
+
+/*! @brief wait for the detection to finish
+ *
+ * @return the final status
+ */
+DetectionStatus DetectionFuture::wait(void) const {
+	DetectionRequest& request = state();
+	boost::mutex::scoped_lock lock(request.mutex_);
+	while (!terminal(request.status_)) request.finished_.wait(lock);
+	return request.status_;
+}
+
+/*! @brief wait for the detection to finish, for at most a given time
+ *
+ * @param milliseconds the longest time to wait
+ * @return true if the detection has finished
+ */
+bool DetectionFuture::wait(unsigned int milliseconds) const {
+	DetectionRequest& request = state();
+	const boost::system_time deadline = boost::get_system_time() + boost::posix_time::milliseconds(milliseconds);
+	boost::mutex::scoped_lock lock(request.mutex_);
+	while (!terminal(request.status_)) {
+		if (!request.finished_.timed_wait(lock, deadline)) break;
+	}
+	return terminal(request.status_);
+}
+
+/*! @brief wait for the detection to finish, and retrieve its candidates
+ *
+ * @param candidates the output candidates, empty unless the detection succeeded
+ * @return the final status
+ */
+DetectionStatus DetectionFuture::get(CandidateSet& candidates) const {
+	const DetectionStatus status = wait();
+	candidates.clear();
+	if (status == DETECTION_DONE) candidates = state().candidates_;
+	return status;
+}
+
+//! the reason the detection failed, if it did
+string DetectionFuture::error(void) const {
+	DetectionRequest& request = state();
+	boost::mutex::scoped_lock lock(request.mutex_);
+	return request.error_;
+}
+
+/*! @brief request cancellation of the detection
+ *
+ * A waiting detection is cancelled as soon as a worker reaches it. A
+ * running detection stops at its next checkpoint, between the stages
+ * of detection. A finished detection is unaffected
+ */
+void DetectionFuture::cancel(void) const {
+	DetectionRequest& request = state();
+	boost::mutex::scoped_lock lock(request.mutex_);
+	request.cancel_ = true;
+}
+
+// ---------------------------------------------------------------------------
+// EXECUTOR
+// ---------------------------------------------------------------------------
+
+/*! @brief start the worker threads
+ *
+ * @param nthreads the number of detections which may run concurrently
+ * @param capacity the number of detections which may wait for a worker,
+ * at least 1
+ * @param policy what to do with a new request when the queue is full
+ */
+DetectionExecutor::DetectionExecutor(unsigned int nthreads, unsigned int capacity, DropPolicy policy) :
+		queue_(capacity), policy_(policy) {
+	for (unsigned int n = 0; n < std::max(nthreads, 1u); ++n) {
+		threads_.create_thread(boost::bind(&DetectionExecutor::work, this));
+	}
+}
+
+DetectionExecutor::~DetectionExecutor() {
+	shutdown();
+}
+
+/*! @brief submit a detection to the executor
+ *
+ * @param task the detection, which writes its output to the request's
+ * candidates and checks cancelled() between its stages. It returns false
+ * if it stopped early
+ * @param callback called on completion, on the worker thread (or on the
+ * calling thread if the request is rejected)
+ * @return a future for the result of the detection
+ */
+DetectionFuture DetectionExecutor::submit(const boost::function<bool (DetectionRequest&)>& task, const DetectionCallback& callback) {
+	boost::shared_ptr<DetectionRequest> request(new DetectionRequest);
+	request->task_ = task;
+	request->callback_ = callback;
+	DetectionFuture future(request);
+
+	boost::shared_ptr<DetectionRequest> dropped;
+	if (queue_.push(request, policy_, dropped)) dropped->finish(DETECTION_REJECTED);
+	return future;
+}
+
+/*! @brief stop admitting requests, cancel those waiting and join the workers
+ *
+ * Running detections are allowed to finish
+ */
+void DetectionExecutor::shutdown(void) {
+	queue_.close();
+	boost::shared_ptr<DetectionRequest> request;
+	while (queue_.tryPop(request)) request->finish(DETECTION_CANCELLED);
+	threads_.join_all();
+}
+
+/*! @brief the worker loop: run each request in turn */
+void DetectionExecutor::work(void) {
+	boost::shared_ptr<DetectionRequest> request;
+	while (queue_.pop(request)) {
+		bool cancelled;
+		{
+			boost::mutex::scoped_lock lock(request->mutex_);
+			cancelled = request->cancel_;
+			if (!cancelled) request->status_ = DETECTION_RUNNING;
+		}
+		if (cancelled) {
+			request->finish(DETECTION_CANCELLED);
+			continue;
+		}
+		// finish outside the try block, so that the callback runs once
+		DetectionStatus status;
+		string error;
+		try {
+			status = request->task_(*request) ? DETECTION_DONE : DETECTION_CANCELLED;
+		} catch (const std::exception& e) {
+			status = DETECTION_FAILED;
+			error  = e.what();
+		} catch (...) {
+			status = DETECTION_FAILED;
+			error  = "unknown exception";
+		}
+		request->finish(status, error);
+		request.reset();
+	}
+}
@@ -0,0 +1,148 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DetectionStats.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include "DetectionStats.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+using namespace std;
+
+/*! @brief open a file to append the stats to
+ *
+ * @param path the path of the file
+ */
+JsonLinesStatsSink::JsonLinesStatsSink(const string& path) : file_(path.c_str(), ios::out | ios::app) {}
+
+/*! @brief append the stats of a detection to the file, as a single line
+ *
+ * @param stats the stats
+ */
+void JsonLinesStatsSink::write(const DetectionStats& stats) {
+
+	// format outside of the lock
+	ostringstream line;
+	line << "{\"seconds\":{"
+		 << "\"resize\":" << stats.resize
+		 << ",\"features\":" << stats.features
+		 << ",\"convolution\":" << stats.convolution
+		 << ",\"messages\":" << stats.messages
+		 << ",\"selection\":" << stats.selection
+		 << ",\"argmin\":" << stats.argmin
+		 << ",\"total\":" << stats.total
+		 << "},\"level_convolution\":[";
+	for (unsigned int n = 0; n < stats.levelconvolution.size(); ++n) {
+		line << (n ? "," : "") << stats.levelconvolution[n];
+	}
+	line << "],\"levels\":" << stats.levels
+		 << ",\"filters\":" << stats.filters
+		 << ",\"responses\":" << stats.responses
+		 << ",\"candidates\":" << stats.candidates
+		 << ",\"bytes\":{"
+		 << "\"features\":" << stats.featurebytes
+		 << ",\"responses\":" << stats.responsebytes
+		 << ",\"dp\":" << stats.dpbytes
+		 << ",\"peak\":" << stats.peakbytes()
+		 << "}}\n";
+
+	boost::mutex::scoped_lock lock(mutex_);
+	file_ << line.str() << flush;
+}
+
+/*! @brief export the stats to a Prometheus text file
+ *
+ * @param path the path of the text file, which should end in .prom
+ * @param prefix the prefix of each metric name
+ */
+PrometheusStatsSink::PrometheusStatsSink(const string& path, const string& prefix) :
+	path_(path), prefix_(prefix), detections_(0), peakbytes_(0) {}
+
+/*! @brief add the stats of a detection to the totals, and rewrite the file
+ *
+ * @param stats the stats
+ */
+void PrometheusStatsSink::write(const DetectionStats& stats) {
+
+	boost::mutex::scoped_lock lock(mutex_);
+	detections_++;
+	totals_.resize      += stats.resize;
+	totals_.features    += stats.features;
+	totals_.convolution += stats.convolution;
+	totals_.messages    += stats.messages;
+	totals_.selection   += stats.selection;
+	totals_.argmin      += stats.argmin;
+	totals_.total       += stats.total;
+	totals_.levels      += stats.levels;
+	totals_.responses   += stats.responses;
+	totals_.candidates  += stats.candidates;
+	peakbytes_ = std::max(peakbytes_, stats.peakbytes());
+
+	const string& p = prefix_;
+	ostringstream text;
+	text << "# HELP " << p << "_detections_total The number of detections.\n"
+		 << "# TYPE " << p << "_detections_total counter\n"
+		 << p << "_detections_total " << detections_ << "\n"
+		 << "# HELP " << p << "_stage_seconds_total The time spent in each stage of detection.\n"
+		 << "# TYPE " << p << "_stage_seconds_total counter\n"
+		 << p << "_stage_seconds_total{stage=\"resize\"} " << totals_.resize << "\n"
+		 << p << "_stage_seconds_total{stage=\"features\"} " << totals_.features << "\n"
+		 << p << "_stage_seconds_total{stage=\"convolution\"} " << totals_.convolution << "\n"
+		 << p << "_stage_seconds_total{stage=\"messages\"} " << totals_.messages << "\n"
+		 << p << "_stage_seconds_total{stage=\"selection\"} " << totals_.selection << "\n"
+		 << p << "_stage_seconds_total{stage=\"argmin\"} " << totals_.argmin << "\n"
+		 << p << "_stage_seconds_total{stage=\"total\"} " << totals_.total << "\n"
+		 << "# HELP " << p << "_levels_total The number of pyramid levels searched.\n"
+		 << "# TYPE " << p << "_levels_total counter\n"
+		 << p << "_levels_total " << totals_.levels << "\n"
+		 << "# HELP " << p << "_responses_total The number of filter responses computed.\n"
+		 << "# TYPE " << p << "_responses_total counter\n"
+		 << p << "_responses_total " << totals_.responses << "\n"
+		 << "# HELP " << p << "_candidates_total The number of candidates returned.\n"
+		 << "# TYPE " << p << "_candidates_total counter\n"
+		 << p << "_candidates_total " << totals_.candidates << "\n"
+		 << "# HELP " << p << "_peak_bytes The largest intermediate state of a detection.\n"
+		 << "# TYPE " << p << "_peak_bytes gauge\n"
+		 << p << "_peak_bytes " << peakbytes_ << "\n";
+
+	// write alongside, then rename into place
+	const string tmp = path_ + ".tmp";
+	{
+		ofstream file(tmp.c_str(), ios::out | ios::trunc);
+		file << text.str();
+		if (!file) return;
+	}
+	std::rename(tmp.c_str(), path_.c_str());
+}
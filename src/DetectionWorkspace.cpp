@@ -0,0 +1,74 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DetectionWorkspace.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include "DetectionWorkspace.hpp"
+#include <boost/bind.hpp>
+using namespace std;
+
+DetectionWorkspacePool::~DetectionWorkspacePool() {
+	clear();
+}
+
+/*! @brief lend a workspace from the pool
+ *
+ * @return the workspace, which returns to the pool when released
+ */
+boost::shared_ptr<DetectionWorkspace> DetectionWorkspacePool::acquire(void) {
+	DetectionWorkspace* workspace = NULL;
+	{
+		boost::mutex::scoped_lock lock(mutex_);
+		if (!free_.empty()) {
+			workspace = free_.back();
+			free_.pop_back();
+		}
+	}
+	if (!workspace) workspace = new DetectionWorkspace;
+	return boost::shared_ptr<DetectionWorkspace>(workspace, boost::bind(&DetectionWorkspacePool::release, this, _1));
+}
+
+/*! @brief return a workspace to the pool */
+void DetectionWorkspacePool::release(DetectionWorkspace* workspace) {
+	boost::mutex::scoped_lock lock(mutex_);
+	free_.push_back(workspace);
+}
+
+/*! @brief destroy the workspaces not currently lent */
+void DetectionWorkspacePool::clear(void) {
+	boost::mutex::scoped_lock lock(mutex_);
+	for (unsigned int n = 0; n < free_.size(); ++n) delete free_[n];
+	free_.clear();
+}
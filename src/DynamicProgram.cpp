@@ -36,15 +36,314 @@
  *  Created: Jun 21, 2012
  */
 
+#include <algorithm>
 #include <cstdio>
 #include <iostream>
 #include <limits>
 #include "Math.hpp"
 #include "DynamicProgram.hpp"
+#include "nms.hpp"
+#include "Trace.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 using namespace cv;
 using namespace std;
 
 
+/*! @brief compile the tree of Parts into the flat schedule used by min() and argmin()
+ *
+ * This must be called whenever the Parts change, before min() or argmin().
+ * The current cascade must suit the new tree, so clear it with setCascade()
+ * beforehand when the tree is replaced by that of another model
+ *
+ * @param parts the tree of Parts
+ */
+template<typename T>
+void DynamicProgram<T>::compile(Parts& parts) {
+	schedule_.compile(parts);
+	checkCascade(cascadethresh_, cascadeorder_);
+	schedule_.setOrder(cascadeorder_);
+}
+
+/*! @brief check that a cascade has a threshold for every stage
+ *
+ * Every component with thresholds must have an order, and one threshold
+ * for its root plus one per subtree in that order. Once compiled, the
+ * number of subtrees must also match the tree (setOrder() then checks that
+ * the order visits each of them exactly once)
+ *
+ * @param thresh the stage thresholds of each component
+ * @param order the order in which the subtrees of each component's root are evaluated
+ */
+template<typename T>
+void DynamicProgram<T>::checkCascade(const vector2Df& thresh, const vector2Di& order) const {
+	if (thresh.size() > order.size()) {
+		CV_Error(CV_StsBadArg, "every component of the cascade with thresholds must have a stage order");
+	}
+	for (unsigned int c = 0; c < thresh.size(); ++c) {
+		if (thresh[c].empty()) continue;
+		if (thresh[c].size() != order[c].size()+1) {
+			CV_Error(CV_StsBadArg, "the cascade must have one threshold for the root and one per subtree in its order");
+		}
+		if (!schedule_.empty() && (c >= schedule_.ncomponents() || thresh[c].size() != schedule_.stages(c).size()+1)) {
+			CV_Error(CV_StsBadArg, "the cascade must have one threshold for the root and one per subtree of the root");
+		}
+	}
+}
+
+/*! @brief the score of the root given the messages received so far
+ *
+ * @param scores the pdfs of part locations at this scale, one per filter
+ * @param c the component of interest
+ * @param ncscores the accumulated messages of each part, one per filter
+ * @param maxv the root score, maximised over the root mixtures
+ * @param maxi the best root mixture
+ */
+template<typename T>
+void DynamicProgram<T>::rootScore(const vectorMat& scores, unsigned int c, const vectorMat& ncscores, Mat& maxv, Mat& maxi) const {
+
+	// add bias to the root score and find the best mixture
+	const typename PartSchedule<T>::Node& root = schedule_.node(c, 0);
+	const T bias = schedule_.rootBias(c);
+	vectorMat weighted;
+	for (int m = 0; m < root.nmixtures; ++m) {
+		const int f = schedule_.mixture(root, m).filter;
+		const Mat& score = ncscores[f].empty() ? scores[f] : ncscores[f];
+		weighted.push_back(score + bias);
+	}
+	Math::reduceMax<T>(weighted, maxv, maxi);
+}
+
+/*! @brief whether to parallelize within each (scale, component) unit
+ *
+ * @param nunits the number of (scale, component) units
+ * @return true if there are too few units to occupy every thread
+ */
+template<typename T>
+bool DynamicProgram<T>::parallelWithin(unsigned int nunits) {
+#ifdef _OPENMP
+	return nunits < (unsigned int)omp_get_max_threads();
+#else
+	return false;
+#endif
+}
+
+/*! @brief mark a (scale, component) unit as not evaluated
+ *
+ * The root scores are set to -inf, as for a unit rejected by the cascade,
+ * so that no candidates are found in it
+ *
+ * @param scores the pdfs of part locations at this scale, one per filter
+ * @param c the component
+ * @param rootv the root scores
+ * @param rooti the root indices
+ */
+template<typename T>
+void DynamicProgram<T>::skipComponent(const vectorMat& scores, unsigned int c, Mat& rootv, Mat& rooti) const {
+	const Size size = scores[schedule_.mixture(schedule_.node(c, 0), 0).filter].size();
+	rootv = Mat(size, DataType<T>::type, Scalar::all(-numeric_limits<T>::infinity()));
+	rooti = Mat::zeros(size, DataType<int>::type);
+}
+
+/*! @brief Pass messages from the leaves of one or more subtrees of the root
+ *
+ * The parts in order(c)[begin,end) are visited in turn, each receiving
+ * messages only from parts within the same subtree of the root. Messages
+ * into the parts of the subtree are accumulated into ncscores, while the
+ * messages into the root are accumulated into rootmsg (one per root mixture)
+ * so that sibling subtrees may be passed concurrently. The algorithm involves
+ * 3 steps:
+ * 		(1) Apply distance transform
+ * 		(2) Shift by the anchor position of the part wrt the parent
+ * 		(3) Downsample if necessary
+ *
+ * @param scores the pdfs of part locations at this scale, one per filter
+ * @param c the component to compute
+ * @param begin the first part to visit, as an index into order(c)
+ * @param end one past the last part to visit, as an index into order(c)
+ * @param ncscores the accumulated messages of each part, one per filter
+ * @param Ix the detection indices in the x direction (may be NULL)
+ * @param Iy the detection indices in the y direction (may be NULL)
+ * @param Ik the best mixture at each pixel (may be NULL)
+ * @param rootmsg the accumulated messages into the root, one per root mixture
+ * @param parallel evaluate the mixtures of each part in parallel
+ */
+template<typename T>
+void DynamicProgram<T>::minSubtree(const vectorMat& scores, unsigned int c, unsigned int begin, unsigned int end, vectorMat& ncscores,
+		vector2DMat* Ix, vector2DMat* Iy, vector2DMat* Ik, vectorMat& rootmsg, bool parallel) const {
+
+	const bool keepargmax = Ix && Iy && Ik;
+	const vectori& order = schedule_.order(c);
+	const int rootsize = schedule_.node(c, 0).nmixtures;
+	rootmsg.resize(rootsize);
+
+	for (unsigned int i = begin; i < end; ++i) {
+
+		// get the part (which may have multiple mixtures associated with it)
+		const typename PartSchedule<T>::Node& part = schedule_.node(c, order[i]);
+		const typename PartSchedule<T>::Node& parent = schedule_.node(c, part.parent);
+		const int p = part.self;
+		if (keepargmax) {
+			(*Ix)[p].resize(part.pnmixtures);
+			(*Iy)[p].resize(part.pnmixtures);
+			(*Ik)[p].resize(part.pnmixtures);
+		}
+
+		// intermediate results for mixtures of this part
+		vectorMat scoresp(part.nmixtures);
+		vectorMat Ixp(part.nmixtures);
+		vectorMat Iyp(part.nmixtures);
+
+		#ifdef _OPENMP
+		#pragma omp parallel for if(parallel)
+		#endif
+		for (int m = 0; m < part.nmixtures; ++m) {
+
+			// raw score outputs
+			const typename PartSchedule<T>::Mixture& mixture = schedule_.mixture(part, m);
+			Mat_<T> score_in, score_dt;
+			Mat_<int> Ix_dt, Iy_dt;
+			if (ncscores[mixture.filter].empty()) {
+				score_in = scores[mixture.filter];
+			} else {
+				score_in = ncscores[mixture.filter];
+			}
+
+			// compute the distance transform
+			Quadratic fx(mixture.ax, mixture.bx);
+			Quadratic fy(mixture.ay, mixture.by);
+			dt_.compute(score_in, fx, fy, mixture.anchor, score_dt, Ix_dt, Iy_dt);
+			scoresp[m] = score_dt;
+			Ixp[m] = Ix_dt;
+			Iyp[m] = Iy_dt;
+		}
+
+		// each parent mixture accumulates into a distinct message
+		#ifdef _OPENMP
+		#pragma omp parallel for if(parallel)
+		#endif
+		for (int m = 0; m < part.pnmixtures; ++m) {
+			// weight each of the child scores
+			vector<T> bias(part.nmixtures);
+			for (int mm = 0; mm < part.nmixtures; ++mm) bias[mm] = schedule_.bias(schedule_.mixture(part, mm), m);
+
+			// compute the max over the mixtures, choose the best indices and update the parent's score
+			Mat* accum;
+			if (part.parent == 0) {
+				accum = &rootmsg[m];
+				if (accum->empty()) *accum = Mat::zeros(scoresp[0].size(), scoresp[0].type());
+			} else {
+				const int f = schedule_.mixture(parent, m).filter;
+				accum = &ncscores[f];
+				if (accum->empty()) scores[f].copyTo(*accum);
+			}
+			if (keepargmax) {
+				Math::reduceMaxAccumulate<T>(scoresp, bias, Ixp, Iyp, *accum, (*Ik)[p][m], (*Ix)[p][m], (*Iy)[p][m]);
+			} else {
+				Mat unused;
+				Math::reduceMaxAccumulate<T>(scoresp, bias, vectorMat(), vectorMat(), *accum, unused, unused, unused);
+			}
+		}
+	}
+}
+
+/*! @brief Pass messages from the leaves to the root of a single component
+ *
+ * This is the inner loop of min(), applied to one component at one scale.
+ *
+ * If any of Ix, Iy or Ik are NULL, the argmax maps are not stored, and
+ * argmin() must instead recover the part placements from ncscores
+ *
+ * If the component has a cascade, the root's subtrees are passed one at a
+ * time, and the partial root score is checked against the stage threshold
+ * after the root filter and after each subtree. Root locations which fail
+ * a stage are discarded, and if none remain, no further distance transforms
+ * are performed for the component. Otherwise all of the root's subtrees are
+ * passed at once.
+ *
+ * When parallel is set, the subtrees passed at once are evaluated
+ * concurrently, or the mixtures of each part if there is only one. This
+ * is used when there are too few (scale, component) units to occupy every
+ * thread
+ *
+ * @param scores the pdfs of part locations at this scale, one per filter
+ * @param c the component to compute
+ * @param ncscores the accumulated messages of each part, one per filter
+ * @param Ix the detection indices in the x direction (may be NULL)
+ * @param Iy the detection indices in the y direction (may be NULL)
+ * @param Ik the best mixture at each pixel (may be NULL)
+ * @param rootv the root scores
+ * @param rooti the root indices
+ * @param stages the partial root score after each stage (may be NULL)
+ * @param parallel parallelize within the component
+ */
+template<typename T>
+void DynamicProgram<T>::minComponent(const vectorMat& scores, unsigned int c, vectorMat& ncscores, vector2DMat* Ix, vector2DMat* Iy, vector2DMat* Ik, Mat& rootv, Mat& rooti, vectorMat* stages, bool parallel) const {
+
+	const bool keepargmax = Ix && Iy && Ik;
+	const unsigned int nparts = schedule_.nparts(c);
+	if (keepargmax) {
+		Ix->resize(nparts);
+		Iy->resize(nparts);
+		Ik->resize(nparts);
+	}
+	ncscores.resize(scores.size());
+
+	// the root locations which have survived the cascade so far
+	const bool cascaded = cascade(c) || stages;
+	const vectori& bounds = schedule_.stages(c);
+	const typename PartSchedule<T>::Node& root = schedule_.node(c, 0);
+	Mat alive;
+
+	for (unsigned int g = 0; g <= bounds.size(); ) {
+
+		// check the partial score against the stage threshold
+		if (cascaded) {
+			Mat partial, partiali;
+			rootScore(scores, c, ncscores, partial, partiali);
+			if (stages) stages->push_back(partial);
+			if (cascade(c)) {
+				Mat over_thresh = partial >= cascadethresh_[c][g];
+				alive = alive.empty() ? over_thresh : (alive & over_thresh);
+				if (countNonZero(alive) == 0) {
+					rootv = Mat(partial.size(), partial.type(), Scalar::all(-numeric_limits<T>::infinity()));
+					rooti = Mat::zeros(partial.size(), DataType<int>::type);
+					return;
+				}
+			}
+		}
+		if (g == bounds.size()) break;
+
+		// pass the subtrees up to the next stage, concurrently if there are several
+		const unsigned int gend = cascaded ? g+1 : bounds.size();
+		const unsigned int nsubtrees = gend - g;
+		vector2DMat rootmsgs(nsubtrees);
+		#ifdef _OPENMP
+		#pragma omp parallel for if(parallel && nsubtrees > 1) schedule(dynamic)
+		#endif
+		for (unsigned int s = 0; s < nsubtrees; ++s) {
+			const unsigned int begin = (g+s == 0) ? 0 : bounds[g+s-1];
+			minSubtree(scores, c, begin, bounds[g+s], ncscores, Ix, Iy, Ik, rootmsgs[s], parallel && nsubtrees == 1);
+		}
+
+		// gather the messages into the root
+		for (int m = 0; m < root.nmixtures; ++m) {
+			const int f = schedule_.mixture(root, m).filter;
+			for (unsigned int s = 0; s < nsubtrees; ++s) {
+				if (rootmsgs[s][m].empty()) continue;
+				if (ncscores[f].empty()) scores[f].copyTo(ncscores[f]);
+				ncscores[f] += rootmsgs[s][m];
+			}
+		}
+		g = gend;
+	}
+
+	// find the best root mixture, discarding locations rejected by the cascade
+	rootScore(scores, c, ncscores, rootv, rooti);
+	if (cascade(c)) rootv.setTo(Scalar::all(-numeric_limits<T>::infinity()), alive == 0);
+}
+
 /*! @brief Get the min of a dynamic program
  *
  * Get the min of a dynamic program by starting at the leaf nodes,
@@ -52,27 +351,27 @@ using namespace std;
  * a tail recursive algorithm which we can unfold since we know that
  * the parts are sorted from the root to the leaves
  *
- * The algorithm involves 3 steps:
- * 		(1) Apply distance transform
- * 		(2) Shift by the anchor position of the part wrt the parent
- * 		(3) Downsample if necessary
+ * The (scale, component) units are started in order, so with a deadline
+ * the scales should be ordered by priority. Units not started before the
+ * deadline are skipped, leaving no candidates
  *
- * @param parts the parts tree, referenced by the root
  * @param scores the probability densities (pdfs) of part locations (fine to coarse)
  * @param Ix the detection indices in the x direction
  * @param Iy the detection indices in the y direction
  * @param Ik the best mixture at each pixel
  * @param rootv the root scores, across scale
  * @param rooti the root indices, across scale
- *
+ * @param deadline the time after which no more units are started
+ * @return false if any unit was skipped
  */
 template<typename T>
-void DynamicProgram<T>::min(Parts& parts, vector2DMat& scores, vector4DMat& Ix, vector4DMat& Iy, vector4DMat& Ik, vector2DMat& rootv, vector2DMat& rooti) {
+bool DynamicProgram<T>::min(vector2DMat& scores, vector4DMat& Ix, vector4DMat& Iy, vector4DMat& Ik, vector2DMat& rootv, vector2DMat& rooti, const Deadline& deadline) const {
 
 	// initialize the outputs, preallocate vectors to make them thread safe
 	// TODO: better initialisation of Ix, Iy, Ik
+	TRACE_SPAN("dp/min");
 	const unsigned int nscales = scores.size();
-	const unsigned int ncomponents = parts.ncomponents();
+	const unsigned int ncomponents = schedule_.ncomponents();
 	Ix.resize(nscales, vector3DMat(ncomponents));
 	Iy.resize(nscales, vector3DMat(ncomponents));
 	Ik.resize(nscales, vector3DMat(ncomponents));
@@ -80,107 +379,336 @@ void DynamicProgram<T>::min(Parts& parts, vector2DMat& scores, vector4DMat& Ix,
 	rooti.resize(nscales, vectorMat(ncomponents));
 
 	// for each scale, and each component, update the scores through message passing
+	// with too few units to occupy every thread, parallelize within each unit instead
+	const bool within = parallelWithin(nscales*ncomponents);
+	unsigned int nskipped = 0;
 	#ifdef _OPENMP
-	#pragma omp parallel for
+	#pragma omp parallel for if(!within) schedule(dynamic) reduction(+:nskipped)
 	#endif
 	for (unsigned int nc = 0; nc < nscales*ncomponents; ++nc) {
 
 		// calculate the inner loop variables from the dual variables
 		const unsigned int n = floor(nc / ncomponents);
 		const unsigned int c = nc % ncomponents;
+		TRACE_SPAN_LEVEL("dp/component", n);
+		if (deadline.expired()) {
+			skipComponent(scores[n], c, rootv[n][c], rooti[n][c]);
+			nskipped++;
+			continue;
+		}
 
-		// allocate the inner loop variables
-		Ix[n][c].resize(parts.nparts(c));
-		Iy[n][c].resize(parts.nparts(c));
-		Ik[n][c].resize(parts.nparts(c));
-		vectorMat ncscores(scores[n].size());
-
-		for (int p = parts.nparts(c)-1; p > 0; --p) {
-
-			// get the component part (which may have multiple mixtures associated with it)
-			ComponentPart cpart = parts.component(c, p);
-			const unsigned int nmixtures  = cpart.nmixtures();
-			const unsigned int pnmixtures = cpart.parent().nmixtures();
-			Ix[n][c][p].resize(pnmixtures);
-			Iy[n][c][p].resize(pnmixtures);
-			Ik[n][c][p].resize(pnmixtures);
-
-			// intermediate results for mixtures of this part
-			vectorMat scoresp;
-			vectorMat Ixp;
-			vectorMat Iyp;
-
-			for (unsigned int m = 0; m < nmixtures; ++m) {
-
-				// raw score outputs
-				Mat_<T> score_in, score_dt;
-				Mat_<int> Ix_dt, Iy_dt;
-				if (cpart.score(ncscores, m).empty()) {
-					score_in = cpart.score(scores[n], m);
-				} else {
-					score_in = cpart.score(ncscores, m);
-				}
+		vectorMat ncscores;
+		minComponent(scores[n], c, ncscores, &Ix[n][c], &Iy[n][c], &Ik[n][c], rootv[n][c], rooti[n][c], NULL, within);
+	}
+	return nskipped == 0;
+}
 
-				// get the anchor position
-				Point anchor = cpart.anchor(m);
-
-				// compute the distance transform
-				vectorf w = cpart.defw(m);
-				Quadratic fx(-w[0], -w[1]);
-				Quadratic fy(-w[2], -w[3]);
-				dt_.compute(score_in, fx, fy, anchor, score_dt, Ix_dt, Iy_dt);
-				scoresp.push_back(score_dt);
-				Ixp.push_back(Ix_dt);
-				Iyp.push_back(Iy_dt);
+/*! @brief Get the min of a dynamic program, without the argmax maps
+ *
+ * Identical to min() above, except that only the accumulated score
+ * messages of each part are retained. These are all that is needed
+ * to recover the part placements of a handful of root locations in
+ * argmin(), and are considerably smaller than Ix, Iy and Ik which
+ * are stored per part, per parent mixture
+ *
+ * @param scores the probability densities (pdfs) of part locations (fine to coarse)
+ * @param messages the accumulated part messages, across scale and component,
+ * indexed by filter
+ * @param rootv the root scores, across scale
+ * @param rooti the root indices, across scale
+ * @param deadline the time after which no more units are started
+ * @return false if any unit was skipped
+ */
+template<typename T>
+bool DynamicProgram<T>::min(vector2DMat& scores, vector3DMat& messages, vector2DMat& rootv, vector2DMat& rooti, const Deadline& deadline) const {
+
+	TRACE_SPAN("dp/min");
+	const unsigned int nscales = scores.size();
+	const unsigned int ncomponents = schedule_.ncomponents();
+	messages.resize(nscales, vector2DMat(ncomponents));
+	rootv.resize(nscales, vectorMat(ncomponents));
+	rooti.resize(nscales, vectorMat(ncomponents));
+
+	// with too few units to occupy every thread, parallelize within each unit instead
+	const bool within = parallelWithin(nscales*ncomponents);
+	unsigned int nskipped = 0;
+	#ifdef _OPENMP
+	#pragma omp parallel for if(!within) schedule(dynamic) reduction(+:nskipped)
+	#endif
+	for (unsigned int nc = 0; nc < nscales*ncomponents; ++nc) {
+		const unsigned int n = nc / ncomponents;
+		const unsigned int c = nc % ncomponents;
+		TRACE_SPAN_LEVEL("dp/component", n);
+		if (deadline.expired()) {
+			skipComponent(scores[n], c, rootv[n][c], rooti[n][c]);
+			nskipped++;
+			continue;
+		}
+
+		vectorMat& ncscores = messages[n][c];
+		minComponent(scores[n], c, ncscores, NULL, NULL, NULL, rootv[n][c], rooti[n][c], NULL, within);
+
+		// leaves receive no messages, so they refer straight to their pdf (no copy)
+		for (unsigned int p = 0; p < schedule_.nparts(c); ++p) {
+			const typename PartSchedule<T>::Node& part = schedule_.node(c, p);
+			for (int m = 0; m < part.nmixtures; ++m) {
+				const int f = schedule_.mixture(part, m).filter;
+				if (ncscores[f].empty()) ncscores[f] = scores[n][f];
 			}
+		}
+	}
+	return nskipped == 0;
+}
 
-			for (unsigned int m = 0; m < pnmixtures; ++m) {
-				vectorMat weighted;
-				// weight each of the child scores
-				// TODO: More elegant way of handling bias
-				for (unsigned int mm = 0; mm < nmixtures; ++mm) {
-					weighted.push_back(scoresp[mm] + cpart.bias(mm)[m]);
-				}
-				// compute the max over the mixtures
-				Mat maxv, maxi;
-				Math::reduceMax<T>(weighted, maxv, maxi);
-
-				// choose the best indices
-				Mat Ixm, Iym;
-				Math::reducePickIndex<int>(Ixp, maxi, Ixm);
-				Math::reducePickIndex<int>(Iyp, maxi, Iym);
-				Ix[n][c][p][m] = Ixm;
-				Iy[n][c][p][m] = Iym;
-				Ik[n][c][p][m] = maxi;
-
-				// update the parent's score
-				ComponentPart parent = cpart.parent();
-				if (parent.score(ncscores,m).empty()) parent.score(scores[n],m).copyTo(parent.score(ncscores,m));
-				parent.score(ncscores,m) += maxv;
-				if (parent.self() == 0) {
-					ComponentPart root = parts.component(c);
-				}
+/*! @brief evaluate the first stage of the cascade
+ *
+ * Determine which (scale, component) units have at least one root location
+ * whose root filter score passes the first stage of the cascade. Only the
+ * responses of the root filters need to have been computed, so the remaining
+ * filters can be convolved for the surviving units alone
+ *
+ * @param scores the probability densities (pdfs) of part locations (fine to coarse)
+ * @param alive nonzero for each (scale, component) unit which survives
+ */
+template<typename T>
+void DynamicProgram<T>::prune(const vector2DMat& scores, vector2Di& alive) const {
+
+	const unsigned int nscales = scores.size();
+	const unsigned int ncomponents = schedule_.ncomponents();
+	alive.assign(nscales, vectori(ncomponents, 1));
+	for (unsigned int n = 0; n < nscales; ++n) {
+		for (unsigned int c = 0; c < ncomponents; ++c) {
+			if (!cascade(c)) continue;
+			vectorMat ncscores(scores[n].size());
+			Mat partial, partiali;
+			double maxv;
+			rootScore(scores[n], c, ncscores, partial, partiali);
+			minMaxLoc(partial, NULL, &maxv);
+			alive[n][c] = (maxv >= cascadethresh_[c][0]);
+		}
+	}
+}
+
+/*! @brief the filters which must be convolved at each scale
+ *
+ * @param alive nonzero for each (scale, component) unit to evaluate
+ * @param roots select the root filters if true, or all other filters if false
+ * @param mask nonzero for each (scale, filter) response to compute
+ */
+template<typename T>
+void DynamicProgram<T>::filterMask(const vector2Di& alive, bool roots, vector2Di& mask) const {
+
+	const unsigned int nscales = alive.size();
+	mask.assign(nscales, vectori(schedule_.nfilters(), 0));
+	for (unsigned int n = 0; n < nscales; ++n) {
+		for (unsigned int c = 0; c < schedule_.ncomponents(); ++c) {
+			if (!alive[n][c]) continue;
+			const unsigned int pbegin = roots ? 0 : 1;
+			const unsigned int pend   = roots ? 1 : schedule_.nparts(c);
+			for (unsigned int p = pbegin; p < pend; ++p) {
+				const typename PartSchedule<T>::Node& part = schedule_.node(c, p);
+				for (int m = 0; m < part.nmixtures; ++m) mask[n][schedule_.mixture(part, m).filter] = 1;
+			}
+		}
+	}
+}
+
+/*! @brief record the partial root scores after each stage of the cascade
+ *
+ * Used to calibrate the cascade thresholds offline. The subtrees are
+ * evaluated in the current cascade order, and no locations are discarded
+ * unless thresholds have been set
+ *
+ * @param scores the probability densities (pdfs) of part locations (fine to coarse)
+ * @param stages the partial root score after each stage, across scale and component
+ * @param rootv the root scores, across scale
+ * @param rooti the root indices, across scale
+ */
+template<typename T>
+void DynamicProgram<T>::stageScores(vector2DMat& scores, vector3DMat& stages, vector2DMat& rootv, vector2DMat& rooti) const {
+
+	const unsigned int nscales = scores.size();
+	const unsigned int ncomponents = schedule_.ncomponents();
+	stages.resize(nscales, vector2DMat(ncomponents));
+	rootv.resize(nscales, vectorMat(ncomponents));
+	rooti.resize(nscales, vectorMat(ncomponents));
+
+	// with too few units to occupy every thread, parallelize within each unit instead
+	const bool within = parallelWithin(nscales*ncomponents);
+	#ifdef _OPENMP
+	#pragma omp parallel for if(!within)
+	#endif
+	for (unsigned int nc = 0; nc < nscales*ncomponents; ++nc) {
+		const unsigned int n = nc / ncomponents;
+		const unsigned int c = nc % ncomponents;
+
+		vectorMat ncscores;
+		minComponent(scores[n], c, ncscores, NULL, NULL, NULL, rootv[n][c], rooti[n][c], &stages[n][c], within);
+	}
+}
+
+/*! @brief find the best placement of a child part about its anchor
+ *
+ * Evaluates the same objective as the distance transform in min(), but
+ * only over a (2*window_+1)^2 neighbourhood of the anchor for a single
+ * parent location. The result is exact whenever the optimal displacement
+ * lies within the window
+ *
+ * @param message the accumulated message of the child mixture
+ * @param mixture the child mixture
+ * @param parent the location of the parent
+ * @param child the best location of the child
+ * @return the score of the child at that location
+ */
+template<typename T>
+T DynamicProgram<T>::localArgmax(const Mat& message, const typename PartSchedule<T>::Mixture& mixture, const Point parent, Point& child) const {
+
+	const Quadratic fx(mixture.ax, mixture.bx);
+	const Quadratic fy(mixture.ay, mixture.by);
+	const Point centre = parent + mixture.anchor;
+	const int xmin = std::max(centre.x - window_, 0);
+	const int ymin = std::max(centre.y - window_, 0);
+	const int xmax = std::min(centre.x + window_, message.cols-1);
+	const int ymax = std::min(centre.y + window_, message.rows-1);
+
+	// fall back to the nearest valid location if the window lies outside the message
+	child = Point(std::min(std::max(centre.x, 0), message.cols-1), std::min(std::max(centre.y, 0), message.rows-1));
+	T best = -numeric_limits<T>::infinity();
+	for (int y = ymin; y <= ymax; ++y) {
+		const T* msg_ptr = message.ptr<T>(y);
+		const T dy = fy(centre.y - y, 0);
+		for (int x = xmin; x <= xmax; ++x) {
+			const T v = msg_ptr[x] + dy + fx(centre.x - x, 0);
+			if (v > best) { best = v; child = Point(x,y); }
+		}
+	}
+	return best;
+}
+
+
+/*! @brief a root location which is a local maximum of its (scale, component) unit */
+template<typename T>
+struct Peak {
+	T score;
+	unsigned int nc;
+	Point loc;
+	Peak(T score, unsigned int nc, Point loc) : score(score), nc(nc), loc(loc) {}
+	//! orders a heap with the lowest score at the top
+	static bool greater(const Peak& p1, const Peak& p2) { return p1.score > p2.score; }
+};
+
+/*! @brief keep only the topK() best root locations
+ *
+ * Each (scale, component) unit of rootv is first reduced to its local
+ * maxima over threshold (see nonMaximaSuppression()), with a window of
+ * half the smallest root filter of the component. The best topK() maxima
+ * across scale and component are then selected with a bounded heap, and
+ * every other location of rootv is set to -infinity so that argmin()
+ * only backtracks the selected trees.
+ *
+ * Overlapping detections at different scales are not suppressed
+ *
+ * @param rootv the root scores, across scale, modified in place
+ */
+template<typename T>
+void DynamicProgram<T>::selectTopK(vector2DMat& rootv) const {
+
+	TRACE_SPAN("dp/selectTopK");
+	const unsigned int nscales = rootv.size();
+	const unsigned int ncomponents = schedule_.ncomponents();
+	if (topk_ == 0 || nscales == 0) return;
+
+	// find the local maxima of every unit at once
+	vectorMat units(nscales*ncomponents), over_thresh(nscales*ncomponents), maxima;
+	vectori sz(nscales*ncomponents);
+	for (unsigned int nc = 0; nc < nscales*ncomponents; ++nc) {
+		const unsigned int n = nc / ncomponents;
+		const unsigned int c = nc % ncomponents;
+		const typename PartSchedule<T>::Node& root = schedule_.node(c, 0);
+		sz[nc] = numeric_limits<int>::max();
+		for (int m = 0; m < root.nmixtures; ++m) {
+			const typename PartSchedule<T>::Mixture& mixture = schedule_.mixture(root, m);
+			sz[nc] = std::min(sz[nc], std::min(mixture.xsize, mixture.ysize) / 2);
+		}
+		sz[nc] = std::max(sz[nc], 1);
+		units[nc] = rootv[n][c];
+		over_thresh[nc] = rootv[n][c] > thresh_;
+	}
+	nonMaximaSuppression(units, sz, maxima, over_thresh);
+
+	vector<vector<Peak<T> > > peaks(nscales*ncomponents);
+	#ifdef _OPENMP
+	#pragma omp parallel for
+	#endif
+	for (unsigned int nc = 0; nc < nscales*ncomponents; ++nc) {
+		vectorPoint inds;
+		Math::find(maxima[nc], inds);
+		for (unsigned int i = 0; i < inds.size(); ++i) {
+			peaks[nc].push_back(Peak<T>(units[nc].at<T>(inds[i]), nc, inds[i]));
+		}
+	}
+
+	// select the best maxima across scale and component
+	vector<Peak<T> > heap;
+	heap.reserve(topk_+1);
+	for (unsigned int nc = 0; nc < nscales*ncomponents; ++nc) {
+		for (unsigned int i = 0; i < peaks[nc].size(); ++i) {
+			if (heap.size() == topk_ && !(peaks[nc][i].score > heap.front().score)) continue;
+			heap.push_back(peaks[nc][i]);
+			std::push_heap(heap.begin(), heap.end(), Peak<T>::greater);
+			if (heap.size() > topk_) {
+				std::pop_heap(heap.begin(), heap.end(), Peak<T>::greater);
+				heap.pop_back();
 			}
 		}
-		// add bias to the root score and find the best mixture
-		ComponentPart root = parts.component(c);
-		Mat rncscore = root.score(ncscores,0);
-		T bias = root.bias(0)[0];
-		vectorMat weighted;
-		// weight each of the child scores
-		for (unsigned int m = 0; m < root.nmixtures(); ++m) {
-			weighted.push_back(root.score(ncscores,m) + bias);
+	}
+
+	// discard everything else
+	for (unsigned int nc = 0; nc < nscales*ncomponents; ++nc) {
+		Mat& unit = rootv[nc / ncomponents][nc % ncomponents];
+		Mat selected(unit.size(), unit.type(), Scalar::all(-numeric_limits<T>::infinity()));
+		for (unsigned int i = 0; i < heap.size(); ++i) {
+			if (heap[i].nc == nc) selected.at<T>(heap[i].loc) = heap[i].score;
 		}
-		Math::reduceMax<T>(weighted, rootv[n][c], rooti[n][c]);
+		unit = selected;
 	}
 }
 
+/*! @brief allocate space for the candidates of each (scale, component) unit
+ *
+ * Counts the root locations over threshold in each unit, and grows the
+ * candidates to hold them all. Each unit can then write its candidates
+ * to its own slice of the output without synchronisation
+ *
+ * @param rootv the root scores, across scale
+ * @param candidates the candidates to grow
+ * @param offsets the index of the first candidate of each unit, followed
+ * by the total number of candidates
+ */
+template<typename T>
+void DynamicProgram<T>::allocateCandidates(const vector2DMat& rootv, CandidateSet& candidates, vectori& offsets) const {
+
+	const unsigned int nscales = rootv.size();
+	const unsigned int ncomponents = schedule_.ncomponents();
+	offsets.resize(nscales*ncomponents+1);
+	#ifdef _OPENMP
+	#pragma omp parallel for
+	#endif
+	for (unsigned int nc = 0; nc < nscales*ncomponents; ++nc) {
+		offsets[nc+1] = Math::countGreater<T>(rootv[nc / ncomponents][nc % ncomponents], thresh_);
+	}
+	for (unsigned int nc = 0; nc < nscales*ncomponents; ++nc) {
+		const unsigned int n = nc / ncomponents;
+		const unsigned int c = nc % ncomponents;
+		offsets[nc] = candidates.grow(offsets[nc+1], schedule_.nparts(c), c, n);
+	}
+	offsets[nscales*ncomponents] = candidates.size();
+}
 
 /*! @brief get the argmin of a dynamic program
  *
  * Get the minimum argument of a dynamic program by traversing down the tree of
  * a dynamic program, returning the locations of the best nodes
- * @param parts the tree of parts, referenced by the root
  * @param rootv the root scores, across scale
  * @param rooti the root indices, across scale
  * @param scales the scales (used to calculate bounding box size)
@@ -190,45 +718,50 @@ void DynamicProgram<T>::min(Parts& parts, vector2DMat& scores, vector4DMat& Ix,
  * @param candidates
  */
 template<typename T>
-void DynamicProgram<T>::argmin(Parts& parts, const vector2DMat& rootv, const vector2DMat& rooti, const vectorf scales, const vector4DMat& Ix, const vector4DMat& Iy, const vector4DMat& Ik, vectorCandidate& candidates) {
+void DynamicProgram<T>::argmin(const vector2DMat& rootv, const vector2DMat& rooti, const vectorf scales, const vector4DMat& Ix, const vector4DMat& Iy, const vector4DMat& Ik, CandidateSet& candidates) const {
 
 	// for each scale, and each component, traverse back down the tree to retrieve the part positions
+	TRACE_SPAN("dp/argmin");
 	const unsigned int nscales = scales.size();
+	const unsigned int ncomponents = schedule_.ncomponents();
+	vectori offsets;
+	allocateCandidates(rootv, candidates, offsets);
 	#ifdef _OPENMP
-	#pragma omp parallel for
+	#pragma omp parallel for schedule(dynamic)
 	#endif
 	for (unsigned int n = 0; n < nscales; ++n) {
+		TRACE_SPAN_LEVEL("dp/backtrack", n);
 		T scale = scales[n];
-		for (unsigned int c = 0; c < parts.ncomponents(); ++c) {
+		for (unsigned int c = 0; c < ncomponents; ++c) {
 
 			// get the scores and indices for this tree of parts
 			const vector2DMat& Iknc = Ik[n][c];
 			const vector2DMat& Ixnc = Ix[n][c];
 			const vector2DMat& Iync = Iy[n][c];
-			const unsigned int nparts = parts.nparts(c);
+			const unsigned int nparts = schedule_.nparts(c);
 
-			// threshold the root score
-			Mat over_thresh = rootv[n][c] > thresh_;
-			Mat rootmix     = rooti[n][c];
+			// threshold the root score, into this unit's slice of the candidates
+			const unsigned int offset = offsets[n*ncomponents+c];
+			Mat rootmix = rooti[n][c];
 			vectorPoint inds;
-			Math::find(over_thresh, inds);
+			inds.reserve(offsets[n*ncomponents+c+1] - offset);
+			Math::findGreater<T>(rootv[n][c], thresh_, inds);
 
 			for (unsigned int i = 0; i < inds.size(); ++i) {
-				Candidate candidate;
-				candidate.setComponent(c);
+				const unsigned int k = offset+i;
 				vectori     xv(nparts);
 				vectori     yv(nparts);
 				vectori     mv(nparts);
 				for (unsigned int p = 0; p < nparts; ++p) {
-					ComponentPart part = parts.component(c, p);
+					const typename PartSchedule<T>::Node& part = schedule_.node(c, p);
 					// calculate the child's points from the parent's points
 					unsigned int x, y, m;
-					if (part.isRoot()) {
+					if (part.parent < 0) {
 						x = xv[0] = inds[i].x;
 						y = yv[0] = inds[i].y;
 						m = mv[0] = rootmix.at<int>(inds[i]);
 					} else {
-						int idx = part.parent().self();
+						int idx = part.parent;
 						x = xv[idx];
 						y = yv[idx];
 						m = mv[idx];
@@ -237,20 +770,93 @@ void DynamicProgram<T>::argmin(Parts& parts, const vector2DMat& rootv, const vec
 						mv[p] = Iknc[p][m].at<int>(y,x);
 					}
 
-					// calculate the bounding rectangle and add it to the Candidate
+					// calculate the bounding rectangle and add it to the candidate
+					const typename PartSchedule<T>::Mixture& mixture = schedule_.mixture(part, mv[p]);
 					Point pone = Point(1,1);
 					Point xy1 = (Point(xv[p],yv[p])-pone)*scale;
-					Point xy2 = xy1 + Point(part.xsize(mv[p]), part.ysize(mv[p]))*scale - pone;
-					if (part.isRoot()) 
-					  candidate.addPart(Rect(xy1, xy2), rootv[n][c].at<T>(inds[i]));
+					Point xy2 = xy1 + Point(mixture.xsize, mixture.ysize)*scale - pone;
+					if (part.parent < 0)
+					  candidates.setPart(k, p, Rect(xy1, xy2), rootv[n][c].at<T>(inds[i]));
 					else
-					  candidate.addPart(Rect(xy1, xy2), 0.0);
+					  candidates.setPart(k, p, Rect(xy1, xy2), 0.0);
 				}
-				#ifdef _OPENMP
-				#pragma omp critical(addcandidate)
-				#endif
-				{
-					candidates.push_back(candidate);
+			}
+		}
+	}
+}
+
+
+/*! @brief get the argmin of a dynamic program, backtracking on demand
+ *
+ * The counterpart of min() without argmax maps. Rather than looking up each
+ * child's placement, it is recomputed from the child's accumulated message by
+ * a local search about its anchor (see localArgmax()). Since this is only done
+ * for the root locations over threshold, it costs a small fraction of the
+ * distance transforms it replaces
+ *
+ * @param rootv the root scores, across scale
+ * @param rooti the root indices, across scale
+ * @param scales the scales (used to calculate bounding box size)
+ * @param messages the accumulated part messages produced by min()
+ * @param candidates
+ */
+template<typename T>
+void DynamicProgram<T>::argmin(const vector2DMat& rootv, const vector2DMat& rooti, const vectorf scales, const vector3DMat& messages, CandidateSet& candidates) const {
+
+	TRACE_SPAN("dp/argmin");
+	const unsigned int nscales = scales.size();
+	const unsigned int ncomponents = schedule_.ncomponents();
+	vectori offsets;
+	allocateCandidates(rootv, candidates, offsets);
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+	#endif
+	for (unsigned int n = 0; n < nscales; ++n) {
+		TRACE_SPAN_LEVEL("dp/backtrack", n);
+		T scale = scales[n];
+		for (unsigned int c = 0; c < ncomponents; ++c) {
+
+			const vectorMat& ncmessages = messages[n][c];
+			const unsigned int nparts = schedule_.nparts(c);
+
+			// threshold the root score, into this unit's slice of the candidates
+			const unsigned int offset = offsets[n*ncomponents+c];
+			Mat rootmix = rooti[n][c];
+			vectorPoint inds;
+			inds.reserve(offsets[n*ncomponents+c+1] - offset);
+			Math::findGreater<T>(rootv[n][c], thresh_, inds);
+
+			for (unsigned int i = 0; i < inds.size(); ++i) {
+				const unsigned int k = offset+i;
+				vectorPoint xy(nparts);
+				vectori     mv(nparts);
+				for (unsigned int p = 0; p < nparts; ++p) {
+					const typename PartSchedule<T>::Node& part = schedule_.node(c, p);
+					if (part.parent < 0) {
+						xy[0] = inds[i];
+						mv[0] = rootmix.at<int>(inds[i]);
+					} else {
+						// choose the child mixture and location which maximise the parent's score
+						const int idx = part.parent;
+						T best = -numeric_limits<T>::infinity();
+						for (int mm = 0; mm < part.nmixtures; ++mm) {
+							const typename PartSchedule<T>::Mixture& mixture = schedule_.mixture(part, mm);
+							Point child;
+							T v = localArgmax(ncmessages[mixture.filter], mixture, xy[idx], child);
+							v += schedule_.bias(mixture, mv[idx]);
+							if (v > best) { best = v; xy[p] = child; mv[p] = mm; }
+						}
+					}
+
+					// calculate the bounding rectangle and add it to the candidate
+					const typename PartSchedule<T>::Mixture& mixture = schedule_.mixture(part, mv[p]);
+					Point pone = Point(1,1);
+					Point xy1 = (xy[p]-pone)*scale;
+					Point xy2 = xy1 + Point(mixture.xsize, mixture.ysize)*scale - pone;
+					if (part.parent < 0)
+					  candidates.setPart(k, p, Rect(xy1, xy2), rootv[n][c].at<T>(inds[i]));
+					else
+					  candidates.setPart(k, p, Rect(xy1, xy2), 0.0);
 				}
 			}
 		}
@@ -258,8 +864,29 @@ void DynamicProgram<T>::argmin(Parts& parts, const vector2DMat& rootv, const vec
 }
 
 
+/*! @brief get the argmin of a dynamic program, as a vector of Candidate
+ *
+ * @see argmin(const vector2DMat&, const vector2DMat&, const vectorf, const vector4DMat&, const vector4DMat&, const vector4DMat&, CandidateSet&)
+ */
+template<typename T>
+void DynamicProgram<T>::argmin(const vector2DMat& rootv, const vector2DMat& rooti, const vectorf scales, const vector4DMat& Ix, const vector4DMat& Iy, const vector4DMat& Ik, vectorCandidate& candidates) const {
+	CandidateSet set;
+	argmin(rootv, rooti, scales, Ix, Iy, Ik, set);
+	set.toCandidates(candidates);
+}
+
+/*! @brief get the argmin of a dynamic program backtracking on demand, as a vector of Candidate
+ *
+ * @see argmin(const vector2DMat&, const vector2DMat&, const vectorf, const vector3DMat&, CandidateSet&)
+ */
+template<typename T>
+void DynamicProgram<T>::argmin(const vector2DMat& rootv, const vector2DMat& rooti, const vectorf scales, const vector3DMat& messages, vectorCandidate& candidates) const {
+	CandidateSet set;
+	argmin(rootv, rooti, scales, messages, set);
+	set.toCandidates(candidates);
+}
+
 
 // declare all specializations of the template (this must be the last declaration in the file)
 template class DynamicProgram<float>;
 template class DynamicProgram<double>;
-
@@ -42,6 +42,10 @@
 
 bool FileStorageModel::serialize(const std::string& filename) const {
 
+	// refuse to write an inconsistent model (the cascade is indexed by component below)
+	std::string problem;
+	if (!validate(problem)) return false;
+
 	// open the storage container for writing
 	cv::FileStorage fs;
 	fs.open(filename, cv::FileStorage::WRITE);
@@ -88,6 +92,19 @@ bool FileStorageModel::serialize(const std::string& filename) const {
 	}
 	fs << "}";
 
+	// write the cascade, if one has been calibrated
+	if (!cascadethresh_.empty()) {
+		fs << "cascade" << "{";
+		for (unsigned int c = 0; c < cascadethresh_.size(); ++c) {
+			std::ostringstream cstr;
+			cstr << "component-" << c;
+			fs << cstr.str() << "{";
+			fs << "order"  << cascadeorder_[c];
+			fs << "thresh" << cascadethresh_[c];
+			fs << "}";
+		}
+		fs << "}";
+	}
 
 	// close the file store
 	fs.release();
@@ -154,6 +171,23 @@ bool FileStorageModel::deserialize(const std::string& filename) {
 		}
 	}
 
+	// read the cascade (optional)
+	cascadethresh_.clear();
+	cascadeorder_.clear();
+	cv::FileNode cascade = fs["cascade"];
+	if (!cascade.empty()) {
+		const unsigned int ncascades = cascade.size();
+		cascadethresh_.resize(ncascades);
+		cascadeorder_.resize(ncascades);
+		for (unsigned int c = 0; c < ncascades; ++c) {
+			std::ostringstream cstr;
+			cstr << "component-" << c;
+			cv::FileNode stages = cascade[cstr.str()];
+			stages["order"]  >> cascadeorder_[c];
+			stages["thresh"] >> cascadethresh_[c];
+		}
+	}
+
 	// close the file store
 	fs.release();
 	return true;
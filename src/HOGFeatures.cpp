@@ -49,6 +49,7 @@ inline double round(double x) { return (x > 0.0) ? floor(x + 0.5) : ceil(x - 0.5
 #include <iostream>
 #include <opencv2/imgproc/imgproc.hpp>
 #include "HOGFeatures.hpp"
+#include "Trace.hpp"
 using namespace std;
 using namespace cv;
 
@@ -66,7 +67,7 @@ static inline T square(const T& x) { return x * x; }
  * @param padsize the amount of padding that was applied (equally to all dimensions)
  */
 template<typename T>
-void HOGFeatures<T>::boundaryOcclusionFeature(Mat& feature, const int flen, const int padsize) {
+void HOGFeatures<T>::boundaryOcclusionFeature(Mat& feature, const int flen, const int padsize) const {
 
 	const unsigned int M = feature.rows;
 	const unsigned int N = feature.cols;
@@ -95,60 +96,111 @@ void HOGFeatures<T>::boundaryOcclusionFeature(Mat& feature, const int flen, cons
  * @param im the input image at native resolution
  * @param pyrafeatures the pyramid of features, fine to coarse, each
  * calculated via features()
+ * @param scales the scale of each level of the pyramid
  */
 template<typename T>
-void HOGFeatures<T>::pyramid(const Mat& im, vectorMat& pyrafeatures) {
+void HOGFeatures<T>::pyramid(const Mat& im, vectorMat& pyrafeatures, vectorf& scales) const {
+	pyramid(im, 0.0f, numeric_limits<float>::infinity(), pyrafeatures, scales);
+}
 
-	// calculate the scaling factor
-	Size_<float> imsize = im.size();
-	nscales_  = 1 + floor(log(min(imsize.height, imsize.width)/(5.0f*(float)binsize_))/log(sfactor_));
+/*! @brief Calculate features over a range of scales
+ *
+ * As pyramid() above, but the features of levels outside [minscale, maxscale]
+ * are left empty. The images of every level are still resampled, since
+ * each octave is downsampled from the one before
+ *
+ * @param im the input image at native resolution
+ * @param minscale the smallest scale to compute
+ * @param maxscale the largest scale to compute
+ * @param pyrafeatures the pyramid of features, fine to coarse
+ * @param scales the scale of each level of the pyramid
+ */
+template<typename T>
+void HOGFeatures<T>::pyramid(const Mat& im, float minscale, float maxscale, vectorMat& pyrafeatures, vectorf& scales) const {
 
+	TRACE_SPAN("hog/pyramid");
 	vectorMat pyraimages;
-	pyraimages.resize(nscales_);
+	images(im, pyraimages, scales);
+	const unsigned int nscales = scales.size();
 	pyrafeatures.clear();
-	pyrafeatures.resize(nscales_);
-	pyraimages.resize(nscales_);
-	scales_.clear();
-	scales_.resize(nscales_);
+	pyrafeatures.resize(nscales);
+
+	// perform the actual feature computation, in parallel if possible
+	#ifdef _OPENMP
+	#pragma omp parallel for
+	#endif
+	for (unsigned int n = 0; n < nscales; ++n) {
+		if (scales[n] < minscale || scales[n] > maxscale) continue;
+		TRACE_SPAN_LEVEL("hog/features", n);
+		features(pyraimages[n], pyrafeatures[n]);
+	}
+}
+
+/*! @brief Resample an image to the scales of the pyramid
+ *
+ * This function supports multithreading via OpenMP
+ *
+ * @param im the input image at native resolution
+ * @param pyraimages the resampled image at each level of the pyramid, fine to coarse
+ * @param scales the scale of each level of the pyramid
+ */
+template<typename T>
+void HOGFeatures<T>::images(const Mat& im, vectorMat& pyraimages, vectorf& scales) const {
+
+	TRACE_SPAN("hog/resize");
+
+	// calculate the number of levels (none for images smaller than 5 bins,
+	// such as small regions of interest)
+	Size_<float> imsize = im.size();
+	const int nlevels = 1 + floor(log(min(imsize.height, imsize.width)/(5.0f*(float)binsize_))/log(sfactor_));
+	const unsigned int nscales = std::max(nlevels, 0);
+
+	pyraimages.clear();
+	pyraimages.resize(nscales);
+	scales.clear();
+	scales.resize(nscales);
 
 	// perform the non-power of two scaling
 	// TODO: is this the most intuitive way to represent scaling?
+	const unsigned int noctave = std::min(interval_, nscales);
 	#ifdef _OPENMP
 	#pragma omp parallel for
 	#endif
-	for (unsigned int i = 0; i < interval_; ++i) {
+	for (unsigned int i = 0; i < noctave; ++i) {
+		TRACE_SPAN_LEVEL("hog/octave", i);
 		Mat scaled;
 		resize(im, scaled, imsize * (1.0f/pow(sfactor_,(int)i)));
 		pyraimages[i] = scaled;
-		scales_[i] = pow(sfactor_,(int)i)*binsize_;
+		scales[i] = pow(sfactor_,(int)i)*binsize_;
 		// perform subsequent power of two scaling
-		for (unsigned int j = i+interval_; j < nscales_; j+=interval_) {
+		for (unsigned int j = i+interval_; j < nscales; j+=interval_) {
 			Mat scaled2;
 			pyrDown(scaled, scaled2);
 			pyraimages[j] = scaled2;
-			scales_[j] = 2 * scales_[j-interval_];
+			scales[j] = 2 * scales[j-interval_];
 			scaled2.copyTo(scaled);
 		}
 	}
+}
 
-	// perform the actual feature computation, in parallel if possible
-	#ifdef _OPENMP
-	#pragma omp parallel for
-	#endif
-	for (unsigned int n = 0; n < nscales_; ++n) {
-		Mat feature;
-		Mat padded;
-		switch (im.depth()) {
-			case CV_32F: features<float>(pyraimages[n], feature); break;
-			case CV_64F: features<double>(pyraimages[n], feature); break;
-			case CV_8U:  features<uint8_t>(pyraimages[n], feature); break;
-			case CV_16U: features<uint16_t>(pyraimages[n], feature); break;
-			default: CV_Error(CV_StsUnsupportedFormat, "Unsupported image type"); break;
-		}
-		//copyMakeBorder(feature, padded, 3, 3, 3*flen_, 3*flen_, BORDER_CONSTANT, 0);
-		//boundaryOcclusionFeature(padded, flen_, 3);
-		pyrafeatures[n] = feature;
+/*! @brief compute the HOG features of a single image, without resampling
+ *
+ * Dispatches to features<IT>() on the depth of the image
+ *
+ * @param im the input image
+ * @param feature the HOG features as a 2D matrix
+ */
+template<typename T>
+void HOGFeatures<T>::features(const Mat& im, Mat& feature) const {
+	switch (im.depth()) {
+		case CV_32F: features<float>(im, feature); break;
+		case CV_64F: features<double>(im, feature); break;
+		case CV_8U:  features<uint8_t>(im, feature); break;
+		case CV_16U: features<uint16_t>(im, feature); break;
+		default: CV_Error(CV_StsUnsupportedFormat, "Unsupported image type"); break;
 	}
+	//copyMakeBorder(feature, padded, 3, 3, 3*flen_, 3*flen_, BORDER_CONSTANT, 0);
+	//boundaryOcclusionFeature(padded, flen_, 3);
 }
 
 /*! @brief compute the HOG features for an image
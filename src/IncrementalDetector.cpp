@@ -0,0 +1,284 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    IncrementalDetector.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include "IncrementalDetector.hpp"
+#include <algorithm>
+#include <opencv2/imgproc/imgproc.hpp>
+using namespace cv;
+using namespace std;
+
+/*! @brief a tile of a level to recompute
+ *
+ * tile is the region recomputed, and crop the region (tile plus halo)
+ * it is computed from, both in feature cells
+ */
+struct DirtyTile {
+	unsigned int level;
+	Rect tile;
+	Rect crop;
+	DirtyTile(unsigned int _level, const Rect& _tile, const Rect& _crop) : level(_level), tile(_tile), crop(_crop) {}
+};
+
+/*! @brief dilate a mask of feature cells by a halo
+ *
+ * @param src the mask
+ * @param halo the number of cells to dilate by
+ * @param dst the dilated mask
+ */
+static void dilateCells(const Mat& src, int halo, Mat& dst) {
+	if (halo <= 0) { src.copyTo(dst); return; }
+	dilate(src, dst, getStructuringElement(MORPH_RECT, Size(2*halo+1, 2*halo+1)));
+}
+
+/*! @brief find the tiles of a level containing any dirty cells
+ *
+ * @param mask the dirty cells of the level
+ * @param level the level
+ * @param tile the width and height of a tile
+ * @param halo the halo of each tile
+ * @param tiles the dirty tiles are appended
+ * @return the total number of tiles in the level
+ */
+static unsigned int dirtyTiles(const Mat& mask, unsigned int level, int tile, int halo, vector<DirtyTile>& tiles) {
+	const Rect bounds(0, 0, mask.cols, mask.rows);
+	unsigned int ntiles = 0;
+	for (int y = 0; y < mask.rows; y += tile) {
+		for (int x = 0; x < mask.cols; x += tile) {
+			const Rect t = Rect(x, y, tile, tile) & bounds;
+			ntiles++;
+			if (countNonZero(mask(t)) == 0) continue;
+			const Rect crop = Rect(t.x-halo, t.y-halo, t.width+2*halo, t.height+2*halo) & bounds;
+			tiles.push_back(DirtyTile(level, t, crop));
+		}
+	}
+	return ntiles;
+}
+
+/*! @brief the region of a tile within its crop */
+static Rect within(const DirtyTile& t) {
+	return Rect(t.tile.x - t.crop.x, t.tile.y - t.crop.y, t.tile.width, t.tile.height);
+}
+
+/*! @brief the columns of a flattened feature map covering a region of cells */
+static Rect columns(const Rect& cells, int flen) {
+	return Rect(cells.x*flen, cells.y, cells.width*flen, cells.height);
+}
+
+/*! @brief search a frame for potential object candidates
+ *
+ * @param im the frame, the same size as the previous frame for an incremental update
+ * @param candidates the output set of detection candidates above the threshold
+ * @param changed the pixels which have changed since the previous frame (CV_8U,
+ * nonzero where changed). If empty, the frame is differenced with the previous one
+ */
+template<typename T>
+void IncrementalDetector<T>::detect(const Mat& im, CandidateSet& candidates, const Mat& changed) {
+
+	if (previous_.empty() || previous_.size() != im.size() || previous_.type() != im.type()) {
+		full(im);
+	} else if (!changed.empty()) {
+		update(im, changed);
+	} else {
+		// the pixels which differ from the previous frame in any channel
+		Mat diff, mask;
+		absdiff(im, previous_, diff);
+		vectorMat channels;
+		split(diff, channels);
+		mask = channels[0];
+		for (unsigned int c = 1; c < channels.size(); ++c) cv::max(mask, channels[c], mask);
+		update(im, mask > threshold_);
+	}
+	im.copyTo(previous_);
+
+	// select the best candidates and backtrack from the cached messages
+	const DynamicProgram<T>& dp = detector_.dp();
+	vector2DMat rootv(rootv_.size());
+	for (unsigned int n = 0; n < rootv_.size(); ++n) {
+		rootv[n].resize(rootv_[n].size());
+		for (unsigned int c = 0; c < rootv_[n].size(); ++c) rootv[n][c] = rootv_[n][c].clone();
+	}
+	if (dp.topK()) dp.selectTopK(rootv);
+	dp.argmin(rootv, rooti_, scales_, messages_, candidates);
+}
+
+/*! @brief compute the state of every level from scratch
+ *
+ * @param im the frame
+ */
+template<typename T>
+void IncrementalDetector<T>::full(const Mat& im) {
+	detector_.features().pyramid(im, features_, scales_);
+	IConvolutionWorkspace& engine = workspace_.convolution(detector_.convolutionEngine());
+	pdf_.clear();
+	detector_.convolutionEngine()->pdf(features_, pdf_, vector2Di(), engine);
+	messages_.clear();
+	rootv_.clear();
+	rooti_.clear();
+	detector_.dp().min(pdf_, messages_, rootv_, rooti_);
+	dirty_ = 1.0;
+}
+
+/*! @brief recompute the tiles of each level touched by a change
+ *
+ * @param im the frame
+ * @param changed nonzero for each pixel which has changed
+ */
+template<typename T>
+void IncrementalDetector<T>::update(const Mat& im, const Mat& changed) {
+
+	const IFeatures& features = detector_.features();
+	const DynamicProgram<T>& dp = detector_.dp();
+	const PartSchedule<T>& schedule = dp.schedule();
+	const int binsize = features.binsize();
+	const unsigned int nlevels = features_.size();
+	if (nlevels == 0) return;
+	const int flen = features_[0].cols / std::max(pdf_[0][0].cols, 1);
+
+	// the halos of the filters, and of the model and backtracking window
+	int fhalo = 0, mhalo = 0;
+	for (unsigned int c = 0; c < schedule.ncomponents(); ++c) {
+		const Rect extent = schedule.extent(c);
+		mhalo = std::max(mhalo, std::max(extent.width, extent.height));
+		for (unsigned int p = 0; p < schedule.nparts(c); ++p) {
+			const typename PartSchedule<T>::Node& part = schedule.node(c, p);
+			for (int m = 0; m < part.nmixtures; ++m) {
+				const typename PartSchedule<T>::Mixture& mixture = schedule.mixture(part, m);
+				fhalo = std::max(fhalo, std::max(mixture.xsize, mixture.ysize));
+			}
+		}
+	}
+	mhalo += dp.window();
+
+	// the dirty cells of each level, with a margin for resampling
+	Mat changedf;
+	changed.convertTo(changedf, DataType<float>::type);
+	vectorMat fmask(nlevels), rmask(nlevels), mmask(nlevels);
+	for (unsigned int n = 0; n < nlevels; ++n) {
+		const Size cells = pdf_[n][0].size();
+		Mat blocks;
+		resize(changedf, blocks, Size(cells.width+2, cells.height+2), 0, 0, INTER_AREA);
+		dilateCells(blocks(Rect(1, 1, cells.width, cells.height)) > 0, 3, fmask[n]);
+		dilateCells(fmask[n], fhalo, rmask[n]);
+		dilateCells(rmask[n], mhalo, mmask[n]);
+	}
+
+	// recompute the features of the dirty tiles, from crops of the resampled frame
+	// aligned to the cell grid, with 2 cells either side of the tile
+	vectorMat images;
+	vectorf scales;
+	features.images(im, images, scales);
+	vector<DirtyTile> ftiles;
+	for (unsigned int n = 0; n < nlevels; ++n) dirtyTiles(fmask[n], n, tile_, 0, ftiles);
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+	#endif
+	for (unsigned int i = 0; i < ftiles.size(); ++i) {
+		const DirtyTile& t = ftiles[i];
+		const Mat& image = images[t.level];
+		const Rect pixels = Rect(Point((t.tile.x-2)*binsize, (t.tile.y-2)*binsize),
+				Point((t.tile.br().x+4)*binsize, (t.tile.br().y+4)*binsize)) & Rect(0, 0, image.cols, image.rows);
+		const Point origin(pixels.x / binsize, pixels.y / binsize);
+		Mat feature;
+		features.features(image(pixels).clone(), feature);
+		const Rect region(t.tile.x - origin.x, t.tile.y - origin.y, t.tile.width, t.tile.height);
+		Mat dst = features_[t.level](columns(t.tile, flen));
+		feature(columns(region, flen)).copyTo(dst);
+	}
+
+	// recompute the responses of the dirty tiles, from crops of the features
+	vector<DirtyTile> rtiles;
+	for (unsigned int n = 0; n < nlevels; ++n) dirtyTiles(rmask[n], n, tile_, fhalo, rtiles);
+	vectorMat crops(rtiles.size());
+	for (unsigned int i = 0; i < rtiles.size(); ++i) {
+		crops[i] = features_[rtiles[i].level](columns(rtiles[i].crop, flen)).clone();
+	}
+	vector2DMat responses;
+	IConvolutionWorkspace& engine = workspace_.convolution(detector_.convolutionEngine());
+	detector_.convolutionEngine()->pdf(crops, responses, vector2Di(), engine);
+	crops.clear();
+	for (unsigned int i = 0; i < rtiles.size(); ++i) {
+		const DirtyTile& t = rtiles[i];
+		for (unsigned int f = 0; f < responses[i].size(); ++f) {
+			Mat dst = pdf_[t.level][f](t.tile);
+			responses[i][f](within(t)).copyTo(dst);
+		}
+	}
+	responses.clear();
+
+	// pass messages over the dirty tiles, from crops of the responses
+	vector<DirtyTile> mtiles;
+	unsigned int ntiles = 0;
+	for (unsigned int n = 0; n < nlevels; ++n) ntiles += dirtyTiles(mmask[n], n, tile_, mhalo, mtiles);
+	dirty_ = (double)mtiles.size() / std::max(ntiles, 1u);
+	vector2DMat scores(mtiles.size());
+	for (unsigned int i = 0; i < mtiles.size(); ++i) {
+		const DirtyTile& t = mtiles[i];
+		scores[i].resize(pdf_[t.level].size());
+		for (unsigned int f = 0; f < scores[i].size(); ++f) scores[i][f] = pdf_[t.level][f](t.crop).clone();
+	}
+	vector3DMat messages;
+	vector2DMat rootv, rooti;
+	dp.min(scores, messages, rootv, rooti);
+
+	// paste the interior of each tile back into the cache
+	for (unsigned int i = 0; i < mtiles.size(); ++i) {
+		const DirtyTile& t = mtiles[i];
+		const Rect region = within(t);
+		for (unsigned int c = 0; c < rootv[i].size(); ++c) {
+			Mat dstv = rootv_[t.level][c](t.tile), dsti = rooti_[t.level][c](t.tile);
+			rootv[i][c](region).copyTo(dstv);
+			rooti[i][c](region).copyTo(dsti);
+			for (unsigned int f = 0; f < messages[i][c].size(); ++f) {
+				const Mat& message = messages[i][c][f];
+				// leaves refer straight to their responses, which are already up to date
+				if (message.empty() || message.data == scores[i][f].data) continue;
+				Mat& cached = messages_[t.level][c][f];
+				if (cached.empty()) {
+					cached = Mat(pdf_[t.level][f].size(), DataType<T>::type, Scalar::all(-numeric_limits<T>::infinity()));
+				} else if (cached.data == pdf_[t.level][f].data) {
+					cached = cached.clone();
+				}
+				Mat dst = cached(t.tile);
+				message(region).copyTo(dst);
+			}
+		}
+	}
+}
+
+// declare all specializations of the template (this must be the last declaration in the file)
+template class IncrementalDetector<float>;
+template class IncrementalDetector<double>;
@@ -0,0 +1,143 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    Model.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include "Model.hpp"
+using namespace std;
+
+/*! @brief check that the parameters of the model are consistent
+ *
+ * Every index must refer to an existing parameter, each part's parent must
+ * precede it, and each part must have the filters, biases and deformations
+ * of all of its mixtures. A cascade must have one stage order per component,
+ * visiting every child of the root exactly once, and a threshold for the
+ * root plus one per subtree. The detector would otherwise read past the end
+ * of the parameters, or silently skip parts
+ *
+ * @param problem set to a description of the first problem found
+ * @return true if the model is consistent
+ */
+bool Model::validate(string& problem) const {
+
+	char str[256];
+	problem.clear();
+	for (unsigned int n = 0; n < filtersw_.size(); ++n) {
+		if (filtersw_[n].empty() || flen_ <= 0 || (filtersw_[n].cols * filtersw_[n].channels()) % flen_ != 0) {
+			sprintf(str, "filter %u is not a whole number of %d-channel cells", n, flen_);
+			problem = str;
+			return false;
+		}
+	}
+
+	const unsigned int ncomponents = filterid_.size();
+	if (biasid_.size() != ncomponents || defid_.size() != ncomponents || parentid_.size() != ncomponents) {
+		problem = "the index tables have different numbers of components";
+		return false;
+	}
+	for (unsigned int c = 0; c < ncomponents; ++c) {
+		const unsigned int nparts = filterid_[c].size();
+		if (nparts == 0 || biasid_[c].size() != nparts || defid_[c].size() != nparts || parentid_[c].size() != nparts) {
+			sprintf(str, "component %u has inconsistent part tables", c);
+			problem = str;
+			return false;
+		}
+		for (unsigned int p = 0; p < nparts; ++p) {
+			const int parent = parentid_[c][p];
+			if ((p == 0 && parent >= 0) || (p > 0 && (parent < 0 || parent >= (int)p))) {
+				sprintf(str, "part %u of component %u has parent %d, which does not precede it", p, c, parent);
+				problem = str;
+				return false;
+			}
+
+			// every mixture needs a filter, a bias per mixture (which must cover the
+			// parent's mixtures) and, except at the root, a deformation
+			const unsigned int nmixtures = filterid_[c][p].size();
+			const unsigned int pnmixtures = p ? filterid_[c][parent].size() : 0;
+			if (nmixtures == 0 || nmixtures < pnmixtures || biasid_[c][p].size() < nmixtures || (p > 0 && defid_[c][p].size() < nmixtures)) {
+				sprintf(str, "part %u of component %u does not have the parameters of all of its mixtures", p, c);
+				problem = str;
+				return false;
+			}
+			for (unsigned int m = 0; m < nmixtures; ++m) {
+				const int filter = filterid_[c][p][m];
+				if (filter < 0 || filter >= (int)filtersw_.size()) {
+					sprintf(str, "part %u of component %u refers to filter %d of %lu", p, c, filter, filtersw_.size());
+					problem = str;
+					return false;
+				}
+				const int bias = biasid_[c][p][m];
+				if (bias < 0 || bias + nmixtures > biasw_.size()) {
+					sprintf(str, "part %u of component %u refers to bias %d of %lu", p, c, bias, biasw_.size());
+					problem = str;
+					return false;
+				}
+				if (p == 0) continue;
+				const int def = defid_[c][p][m];
+				if (def < 0 || def >= (int)defw_.size() || def >= (int)anchors_.size() || defw_[def].size() < 4) {
+					sprintf(str, "part %u of component %u refers to deformation %d of %lu", p, c, def, defw_.size());
+					problem = str;
+					return false;
+				}
+			}
+		}
+	}
+
+	// each cascade visits every subtree of the root once, with a threshold per
+	// subtree and one for the root
+	if (cascadethresh_.empty()) return true;
+	if (cascadethresh_.size() != ncomponents || cascadeorder_.size() != ncomponents) {
+		problem = "the cascade does not have one set of stages per component";
+		return false;
+	}
+	for (unsigned int c = 0; c < ncomponents; ++c) {
+		vectori order(cascadeorder_[c]), children;
+		for (unsigned int p = 1; p < parentid_[c].size(); ++p) if (parentid_[c][p] == 0) children.push_back(p);
+		std::sort(order.begin(), order.end());
+		if (order != children) {
+			sprintf(str, "the cascade of component %u does not visit every subtree of the root exactly once", c);
+			problem = str;
+			return false;
+		}
+		if (cascadethresh_[c].size() != order.size()+1) {
+			sprintf(str, "the cascade of component %u has %lu thresholds for %lu subtrees", c, cascadethresh_[c].size(), order.size());
+			problem = str;
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,121 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    ModelCompiler.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <opencv2/core/core.hpp>
+#include "BinaryModel.hpp"
+#include "FileStorageModel.hpp"
+#include "MatlabIOModel.hpp"
+#include "PartSchedule.hpp"
+#include "Parts.hpp"
+#include "SpatialConvolutionEngine.hpp"
+using namespace cv;
+using namespace std;
+
+int main(int argc, char** argv) {
+
+	// check arguments
+	const bool dbl = argc == 4 && strcmp(argv[3], "--double") == 0;
+	if (argc != 3 && !dbl) {
+		printf("Usage: ModelCompiler model_file output_file.pbm [--double]\n");
+		exit(-1);
+	}
+
+	// determine the type of model to read
+	boost::scoped_ptr<Model> model;
+	string ext = boost::filesystem::path(argv[1]).extension().string();
+	if (ext.compare(".xml") == 0 || ext.compare(".yaml") == 0) {
+		model.reset(new FileStorageModel);
+	} else if (ext.compare(".pbm") == 0) {
+		model.reset(new BinaryModel);
+#ifdef WITH_MATLABIO
+	} else if (ext.compare(".mat") == 0) {
+		model.reset(new MatlabIOModel);
+#endif
+	} else {
+		printf("Unsupported model format: %s\n", ext.c_str());
+		exit(-2);
+	}
+	if (!model->deserialize(argv[1])) {
+		printf("Error deserializing file\n");
+		exit(-3);
+	}
+	string problem;
+	if (!model->validate(problem)) {
+		printf("Invalid model: %s\n", problem.c_str());
+		exit(-4);
+	}
+
+	// convert the filters to the precision of the detector, then lay them out for its engine
+	const int depth = dbl ? CV_64F : CV_32F;
+	BinaryModel compiled(depth);
+	static_cast<Model&>(compiled) = *model;
+	for (unsigned int n = 0; n < compiled.filters().size(); ++n) {
+		if (compiled.filters()[n].depth() == depth) continue;
+		Mat filter;
+		compiled.filters()[n].convertTo(filter, depth);
+		compiled.filters()[n] = filter;
+	}
+	SpatialConvolutionEngine engine(depth, compiled.flen());
+	engine.compileFilters(compiled.filters(), compiled.compiledFilters());
+
+	// compile the schedule of the dynamic program, as the detector will, and summarise it
+	Parts parts(compiled.filters(), compiled.filtersi(), compiled.def(), compiled.defi(), compiled.bias(), compiled.biasi(),
+			compiled.anchors(), compiled.biasid(), compiled.filterid(), compiled.defid(), compiled.parentid());
+	PartSchedule<float> schedule;
+	schedule.compile(parts);
+	schedule.setOrder(compiled.cascadeOrder());
+	printf("%s: %u components, %u filters (%s), %s\n", compiled.name().c_str(), schedule.ncomponents(), schedule.nfilters(),
+			dbl ? "double" : "float", compiled.cascadeThresh().empty() ? "no cascade" : "with cascade");
+	for (unsigned int c = 0; c < schedule.ncomponents(); ++c) {
+		const Rect extent = schedule.extent(c);
+		printf("  component %u: %u parts, %lu subtrees, extent %dx%d cells\n", c, schedule.nparts(c),
+				schedule.stages(c).size(), extent.width, extent.height);
+	}
+
+	if (!compiled.serialize(argv[2])) {
+		printf("Error serializing file\n");
+		exit(-5);
+	}
+	printf("Compiled model written to %s\n", argv[2]);
+	return 0;
+}
@@ -37,6 +37,8 @@
  */
 
 #include <iostream>
+#include <boost/filesystem.hpp>
+#include "BinaryModel.hpp"
 #include "MatlabIOModel.hpp"
 #include "FileStorageModel.hpp"
 using namespace std;
@@ -45,12 +47,14 @@ int main(int argc, char** argv) {
 
 	// check for usage
 	if (argc != 3) {
-		cerr << "Usage: ModelTransfer /path/to/mat/file /path/to/xml/file" << endl;
+		cerr << "Usage: ModelTransfer /path/to/mat/file /path/to/xml/or/pbm/file" << endl;
 		exit(-1);
 	}
 	// allocate two models
+	// (the output format is chosen by extension: .pbm is binary)
+	const bool binary = boost::filesystem::path(argv[2]).extension().string().compare(".pbm") == 0;
 	Model* matlab = new MatlabIOModel;
-	Model* cv     = new FileStorageModel;
+	Model* cv     = binary ? static_cast<Model*>(new BinaryModel) : static_cast<Model*>(new FileStorageModel);
 
 	// deserialize the Matlab model, cast sideways and serialize
 	// an OpenCV FileStorage model
@@ -62,7 +66,7 @@ int main(int argc, char** argv) {
 	matlab->deserialize(argv[1]);
 	cout << "converting..." << endl;
 	(*cv) = (*matlab);
-	cout << "serializing to OpenCV (.xml) model..." << endl;
+	cout << (binary ? "serializing to binary (.pbm) model..." : "serializing to OpenCV (.xml) model...") << endl;
 	cv->serialize(argv[2]);
 	cout << "Conversion complete" << endl;
 	cout << "-------------------------------" << endl;
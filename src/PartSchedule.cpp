@@ -0,0 +1,177 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    PartSchedule.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include "PartSchedule.hpp"
+#include <algorithm>
+using namespace cv;
+using namespace std;
+
+/*! @brief compile the schedule from a tree of Parts
+ *
+ * The subtrees of each root are visited in their natural order until
+ * setOrder() is called
+ *
+ * @param parts the tree of Parts
+ */
+template<typename T>
+void PartSchedule<T>::compile(Parts& parts) {
+
+	nodes_.clear();
+	mixtures_.clear();
+	bias_.clear();
+	components_.clear();
+	rootbias_.clear();
+	nfilters_ = parts.filters().size();
+
+	const unsigned int ncomponents = parts.ncomponents();
+	for (unsigned int c = 0; c < ncomponents; ++c) {
+		components_.push_back(nodes_.size());
+		rootbias_.push_back(parts.component(c).bias(0)[0]);
+		const unsigned int nparts = parts.nparts(c);
+		for (unsigned int p = 0; p < nparts; ++p) {
+			ComponentPart cpart = parts.component(c, p);
+			Node node;
+			node.self       = p;
+			node.parent     = cpart.isRoot() ? -1 : cpart.parent().self();
+			node.nmixtures  = cpart.nmixtures();
+			node.pnmixtures = cpart.isRoot() ? 0 : cpart.parent().nmixtures();
+			node.mixtures   = mixtures_.size();
+			node.subtree    = (node.parent <= 0) ? p : nodes_[components_[c]+node.parent].subtree;
+			nodes_.push_back(node);
+
+			for (int m = 0; m < node.nmixtures; ++m) {
+				Mixture mixture;
+				mixture.filter = cpart.filterid(m);
+				mixture.xsize  = cpart.xsize(m);
+				mixture.ysize  = cpart.ysize(m);
+				mixture.bias   = bias_.size();
+				if (!cpart.isRoot()) {
+					const vectorf w = cpart.defw(m);
+					const vectorf b = cpart.bias(m);
+					mixture.anchor = cpart.anchor(m);
+					mixture.ax = -w[0];
+					mixture.bx = -w[1];
+					mixture.ay = -w[2];
+					mixture.by = -w[3];
+					for (int pm = 0; pm < node.pnmixtures; ++pm) bias_.push_back(b[pm]);
+				}
+				mixtures_.push_back(mixture);
+			}
+		}
+	}
+	setOrder(vector2Di());
+}
+
+/*! @brief set the order in which the subtrees of each root are visited
+ *
+ * Raises an error, leaving the order unchanged, if an order is given for a
+ * component which does not exist, or does not visit every child of the
+ * root exactly once (any subtree left out would never be scored)
+ *
+ * @param order the children of the root of each component, in the order their
+ * subtrees should be visited. Components with no order use the natural order
+ */
+template<typename T>
+void PartSchedule<T>::setOrder(const vector2Di& order) {
+
+	const unsigned int ncomponents = components_.size();
+	if (order.size() > ncomponents) {
+		CV_Error(CV_StsBadArg, "the order has more components than the schedule");
+	}
+	for (unsigned int c = 0; c < order.size(); ++c) {
+		if (order[c].empty()) continue;
+		vectori children, sorted(order[c]);
+		for (int p = 1; p < (int)nparts(c); ++p) if (node(c,p).parent == 0) children.push_back(p);
+		std::sort(sorted.begin(), sorted.end());
+		if (sorted != children) {
+			CV_Error(CV_StsBadArg, "the order must visit every child of the root exactly once");
+		}
+	}
+
+	order_.assign(ncomponents, vectori());
+	stages_.assign(ncomponents, vectori());
+	for (unsigned int c = 0; c < ncomponents; ++c) {
+		const int nparts = this->nparts(c);
+		vectori children;
+		if (c < order.size() && !order[c].empty()) {
+			children = order[c];
+		} else {
+			for (int p = 1; p < nparts; ++p) if (node(c,p).parent == 0) children.push_back(p);
+		}
+		for (unsigned int g = 0; g < children.size(); ++g) {
+			for (int p = nparts-1; p > 0; --p) {
+				if (node(c,p).subtree == children[g]) order_[c].push_back(p);
+			}
+			stages_[c].push_back(order_[c].size());
+		}
+	}
+}
+
+/*! @brief the region covered by the parts of a component at rest
+ *
+ * The union over every combination of mixtures of the part filters placed
+ * at their anchors, relative to the top left of the root filter, in
+ * feature cells. Deformations may move parts beyond the extent
+ *
+ * @param c the component
+ * @return the extent of the component
+ */
+template<typename T>
+Rect PartSchedule<T>::extent(unsigned int c) const {
+
+	// the range of top left positions of each part, over all mixtures
+	const unsigned int nparts = this->nparts(c);
+	vector<Point> lo(nparts), hi(nparts);
+	Rect extent;
+	for (unsigned int p = 0; p < nparts; ++p) {
+		const Node& part = node(c, p);
+		for (int m = 0; m < part.nmixtures; ++m) {
+			const Mixture& mix = mixture(part, m);
+			const Point plo = part.parent < 0 ? Point(0,0) : lo[part.parent] + mix.anchor;
+			const Point phi = part.parent < 0 ? Point(0,0) : hi[part.parent] + mix.anchor;
+			lo[p] = m == 0 ? plo : Point(std::min(lo[p].x, plo.x), std::min(lo[p].y, plo.y));
+			hi[p] = m == 0 ? phi : Point(std::max(hi[p].x, phi.x), std::max(hi[p].y, phi.y));
+			const Rect covered(plo, phi + Point(mix.xsize, mix.ysize));
+			extent = (p == 0 && m == 0) ? covered : (extent | covered);
+		}
+	}
+	return extent;
+}
+
+// declare all specializations of the template (this must be the last declaration in the file)
+template class PartSchedule<float>;
+template class PartSchedule<double>;
@@ -40,10 +40,77 @@
 #include "nms.hpp"
 #include "HOGFeatures.hpp"
 #include "SpatialConvolutionEngine.hpp"
+#include "Trace.hpp"
+#include <algorithm>
 #include <cstdio>
+#include <cstdlib>
+#include <boost/bind.hpp>
 using namespace cv;
 using namespace std;
 
+/*! @brief orders pyramid levels by their distance from a prior level */
+struct NearerLevel {
+	int prior;
+	NearerLevel(int _prior) : prior(_prior) {}
+	bool operator()(int a, int b) const { return abs(a - prior) < abs(b - prior); }
+};
+
+/*! @brief the order in which to evaluate the levels of a pyramid under a time budget
+ *
+ * @param nlevels the number of levels in the pyramid
+ * @param prior the most likely level, or -1 to evaluate coarse to fine
+ * @param order the levels, highest priority first
+ */
+static void levelPriority(unsigned int nlevels, int prior, vectori& order) {
+	order.resize(nlevels);
+	for (unsigned int n = 0; n < nlevels; ++n) order[n] = nlevels-1-n;
+	if (prior >= 0) std::stable_sort(order.begin(), order.end(), NearerLevel(prior));
+}
+
+//! the number of seconds since a tick count
+static inline double elapsed(double t) {
+	return ((double)getTickCount() - t)/getTickFrequency();
+}
+
+//! the total size of the data of a set of matrices, in bytes
+static size_t bytes(const vectorMat& mats) {
+	size_t total = 0;
+	for (unsigned int n = 0; n < mats.size(); ++n) total += mats[n].total() * mats[n].elemSize();
+	return total;
+}
+static size_t bytes(const vector2DMat& mats) {
+	size_t total = 0;
+	for (unsigned int n = 0; n < mats.size(); ++n) total += bytes(mats[n]);
+	return total;
+}
+static size_t bytes(const vector3DMat& mats) {
+	size_t total = 0;
+	for (unsigned int n = 0; n < mats.size(); ++n) total += bytes(mats[n]);
+	return total;
+}
+static size_t bytes(const vector4DMat& mats) {
+	size_t total = 0;
+	for (unsigned int n = 0; n < mats.size(); ++n) total += bytes(mats[n]);
+	return total;
+}
+
+//! record the size of a feature pyramid, and the time taken to compute it
+static void pyramidStats(const vectorMat& pyramid, double seconds, DetectionStats& stats) {
+	stats.features = seconds;
+	stats.levels = pyramid.size();
+	stats.featurebytes = bytes(pyramid);
+}
+
+//! record the number and size of the filter responses computed
+static void countResponses(const vector2DMat& pdf, DetectionStats& stats) {
+	stats.filters = pdf.empty() ? 0 : pdf[0].size();
+	stats.responses = 0;
+	for (unsigned int n = 0; n < pdf.size(); ++n) {
+		for (unsigned int f = 0; f < pdf[n].size(); ++f) stats.responses += !pdf[n][f].empty();
+	}
+	stats.responsebytes = bytes(pdf);
+}
+
 /*! @brief search an image for potential candidates
  *
  * calls detect(const Mat& im, const Mat&depth=Mat(), vector<Candidate>& candidates);
@@ -52,7 +119,7 @@ using namespace std;
  * @param candidates the output vector of detection candidates above the threshold
  */
 template<typename T>
-void PartsBasedDetector<T>::detect(const cv::Mat& im, vectorCandidate& candidates) {
+void PartsBasedDetector<T>::detect(const cv::Mat& im, vectorCandidate& candidates) const {
 	detect(im, Mat(), candidates);
 }
 
@@ -67,40 +134,663 @@ void PartsBasedDetector<T>::detect(const cv::Mat& im, vectorCandidate& candidate
  * @param candidates the output vector of detection candidates above the threshold
  */
 template<typename T>
-void PartsBasedDetector<T>::detect(const Mat& im, const Mat& depth, vectorCandidate& candidates) {
+void PartsBasedDetector<T>::detect(const Mat& im, const Mat& depth, vectorCandidate& candidates) const {
+	CandidateSet set;
+	detect(im, depth, set);
+	set.toCandidates(candidates);
+}
+
+/*! @brief search an image for potential candidates
+ *
+ * calls detect(const Mat& im, const Mat&depth=Mat(), CandidateSet& candidates);
+ *
+ * @param im the input color or grayscale image
+ * @param candidates the output set of detection candidates above the threshold
+ */
+template<typename T>
+void PartsBasedDetector<T>::detect(const cv::Mat& im, CandidateSet& candidates) const {
+	detect(im, Mat(), candidates);
+}
+
+/*! @brief search an image for potential object candidates
+ *
+ * Identical to detect(const Mat&, const Mat&, vectorCandidate&), except that the
+ * candidates are returned in a CandidateSet, which avoids allocating each
+ * candidate separately
+ *
+ * @param im the input color or grayscale image
+ * @param depth the image depth image, used for depth consistency and search space pruning
+ * @param candidates the output set of detection candidates above the threshold
+ */
+template<typename T>
+void PartsBasedDetector<T>::detect(const Mat& im, const Mat& depth, CandidateSet& candidates) const {
+	boost::shared_ptr<DetectionWorkspace> workspace = workspaces_.acquire();
+	detect(im, depth, candidates, *workspace);
+}
+
+/*! @brief search an image for potential object candidates, using the caller's workspace
+ *
+ * Identical to detect(const Mat&, const Mat&, CandidateSet&), except that the
+ * scratch state is taken from the caller rather than the detector's pool.
+ * Concurrent calls must use different workspaces
+ *
+ * @param im the input color or grayscale image
+ * @param depth the image depth image, used for depth consistency and search space pruning
+ * @param candidates the output set of detection candidates above the threshold
+ * @param workspace the scratch state of the call
+ */
+template<typename T>
+void PartsBasedDetector<T>::detect(const Mat& im, const Mat& depth, CandidateSet& candidates, DetectionWorkspace& workspace) const {
+	if (stats_sink_) {
+		DetectionStats stats;
+		detectImage(im, depth, candidates, workspace, &stats);
+		stats_sink_->write(stats);
+	} else {
+		detectImage(im, depth, candidates, workspace, NULL);
+	}
+}
+
+/*! @brief search an image for potential object candidates, and measure the detection
+ *
+ * Identical to detect(const Mat&, const Mat&, CandidateSet&), except that
+ * the duration of each stage, the sizes of the pyramid and the candidates,
+ * and the memory of the intermediate state are returned. The stats are
+ * also written to the stats sink, if one is set (see setStatsSink())
+ *
+ * @param im the input color or grayscale image
+ * @param depth the image depth image, used for depth consistency and search space pruning
+ * @param candidates the output set of detection candidates above the threshold
+ * @param stats the stats of the detection
+ */
+template<typename T>
+void PartsBasedDetector<T>::detect(const Mat& im, const Mat& depth, CandidateSet& candidates, DetectionStats& stats) const {
+	boost::shared_ptr<DetectionWorkspace> workspace = workspaces_.acquire();
+	stats.clear();
+	detectImage(im, depth, candidates, *workspace, &stats);
+	if (stats_sink_) stats_sink_->write(stats);
+}
+
+/*! @brief the detection pipeline of a single image
+ *
+ * @param im the input color or grayscale image
+ * @param depth the image depth image, used for depth consistency and search space pruning
+ * @param candidates the output set of detection candidates above the threshold
+ * @param workspace the scratch state of the call
+ * @param stats if not NULL, receives the stats of the detection
+ */
+template<typename T>
+void PartsBasedDetector<T>::detectImage(const Mat& im, const Mat& depth, CandidateSet& candidates, DetectionWorkspace& workspace, DetectionStats* stats) const {
 
 	// calculate a feature pyramid for the new image
+	TRACE_SPAN("detect");
+	const double t = (double)getTickCount();
+	vectorMat features;
+	vectorf scales;
+	pyramid(im, features, scales, stats);
+
+	// convolve, then find the candidates
+	vector2DMat pdf;
+	convolve(features, pdf, workspace, stats);
+	vectori levels(2, 0);
+	levels[1] = pdf.size();
+	solve(pdf, scales, levels, candidates, NULL, Deadline(), NULL, stats);
+	if (stats) stats->total = elapsed(t);
+
+	if (!depth.empty()) {
+		//ssp_.filterCandidatesByDepth(parts_, candidates, depth, 0.03);
+	}
+
+}
+
+/*! @brief search an image for potential object candidates, within a time budget
+ *
+ * The pyramid levels are convolved one at a time in order of priority
+ * (see DetectionBudget) until the budget runs out, and the dynamic program
+ * then starts no more (level, component) units once it has expired. The
+ * best candidates among the levels evaluated are returned, so with a
+ * tight budget the results are partial but on time. The feature pyramid
+ * and the final backtracking of the selected candidates (see setTopK())
+ * always run to completion. The stats written to the stats sink, if one
+ * is set, count only the levels convolved
+ *
+ * @param im the input color or grayscale image
+ * @param depth the image depth image, used for depth consistency and search space pruning
+ * @param candidates the output set of detection candidates above the threshold
+ * @param budget the time budget and the level prior
+ * @return true if every level was evaluated, or false if the candidates are partial
+ */
+template<typename T>
+bool PartsBasedDetector<T>::detect(const Mat& im, const Mat& depth, CandidateSet& candidates, const DetectionBudget& budget) const {
+
+	const Deadline deadline = budget.deadline();
+	const double t = (double)getTickCount();
+	DetectionStats statsink;
+	DetectionStats* stats = stats_sink_ ? &statsink : NULL;
+	boost::shared_ptr<DetectionWorkspace> workspace = workspaces_.acquire();
+	vectorMat features;
+	vectorf scales;
+	pyramid(im, features, scales, stats);
+
+	// convolve the levels in order of priority, until the budget runs out
+	const unsigned int nlevels = features.size();
+	vectori order;
+	levelPriority(nlevels, budget.level(), order);
+	vector2DMat pdf;
+	vectorf pdfscales;
+	const double tconvolve = (double)getTickCount();
+	if (stats) stats->levelconvolution.resize(nlevels, 0.0);
+	for (unsigned int k = 0; k < nlevels && !deadline.expired(); ++k) {
+		const double tlevel = (double)getTickCount();
+		vector2DMat level;
+		convolve(vectorMat(1, features[order[k]]), level, *workspace);
+		pdf.push_back(level[0]);
+		pdfscales.push_back(scales[order[k]]);
+		if (stats) stats->levelconvolution[order[k]] = elapsed(tlevel);
+	}
+	if (stats) {
+		stats->convolution = elapsed(tconvolve);
+		countResponses(pdf, *stats);
+	}
+
+	// find the candidates among the levels convolved, then map them back to the pyramid
+	const unsigned int first = candidates.size();
+	vectori levels(2, 0);
+	levels[1] = pdf.size();
+	bool complete = pdf.size() == nlevels;
+	bool solved = true;
+	solve(pdf, pdfscales, levels, candidates, NULL, deadline, &solved, stats);
+	for (unsigned int k = first; k < candidates.size(); ++k) {
+		candidates.setScale(k, order[candidates.scale(k)]);
+	}
+	if (stats) {
+		stats->total = elapsed(t);
+		stats_sink_->write(*stats);
+	}
+	return complete && solved;
+}
+
+/*! @brief search regions of an image for potential object candidates
+ *
+ * calls detect(const Mat& im, const vector<DetectionRoi>& rois, CandidateSet& candidates);
+ *
+ * @param im the input color or grayscale image
+ * @param rois the regions to search, and the scales to search them at
+ * @param candidates the output vector of detection candidates above the threshold
+ */
+template<typename T>
+void PartsBasedDetector<T>::detect(const Mat& im, const vector<DetectionRoi>& rois, vectorCandidate& candidates) const {
+	CandidateSet set;
+	detect(im, rois, set);
+	set.toCandidates(candidates);
+}
+
+/*! @brief search regions of an image for potential object candidates
+ *
+ * Each region is padded by the extent of the model at the largest scale
+ * it is searched at, so that the filters see the same context as they
+ * would in the full image. Regions which overlap once padded are merged,
+ * so shared pixels are only processed once. Only the padded regions are
+ * resampled, and features are only computed at the scales of the regions.
+ * The pyramids of all regions are then detected together, as for a batch
+ * (see detect(const vector<Mat>&, vector<CandidateSet>&)), and the
+ * candidates are mapped back to the levels and coordinates of the image.
+ * The stats written to the stats sink, if one is set, time the resampling
+ * and feature computation of the regions together as features
+ *
+ * @param im the input color or grayscale image
+ * @param rois the regions to search, and the scales to search them at
+ * @param candidates the output set of detection candidates above the threshold
+ */
+template<typename T>
+void PartsBasedDetector<T>::detect(const Mat& im, const vector<DetectionRoi>& rois, CandidateSet& candidates) const {
+
+	const double t = (double)getTickCount();
+	DetectionStats statsink;
+	DetectionStats* stats = stats_sink_ ? &statsink : NULL;
+
+	// the extent of the model, in feature cells
+	Size extent(1, 1);
+	for (unsigned int c = 0; c < dp_.schedule().ncomponents(); ++c) {
+		const Rect e = dp_.schedule().extent(c);
+		extent = Size(std::max(extent.width, e.width), std::max(extent.height, e.height));
+	}
+
+	// pad each region by the extent of the model at its largest scale
+	const Rect bounds(0, 0, im.cols, im.rows);
+	const float fits = std::min((float)im.cols / extent.width, (float)im.rows / extent.height);
+	vector<Rect> regions;
+	vector<vectori> members;
+	vectorf minscale, maxscale;
+	for (unsigned int r = 0; r < rois.size(); ++r) {
+		const Rect& rect = rois[r].rect();
+		const float scale = std::min(rois[r].maxscale(), fits);
+		const Size pad(ceil(extent.width*scale), ceil(extent.height*scale));
+		const Rect padded = Rect(rect.x - pad.width, rect.y - pad.height, rect.width + 2*pad.width, rect.height + 2*pad.height) & bounds;
+		if (padded.area() == 0) continue;
+		regions.push_back(padded);
+		members.push_back(vectori(1, r));
+		minscale.push_back(rois[r].minscale());
+		maxscale.push_back(rois[r].maxscale());
+	}
+
+	// merge regions which overlap, until none do
+	for (bool merged = true; merged; ) {
+		merged = false;
+		for (unsigned int i = 0; i < regions.size() && !merged; ++i) {
+			for (unsigned int j = i+1; j < regions.size() && !merged; ++j) {
+				if ((regions[i] & regions[j]).area() == 0) continue;
+				regions[i] = regions[i] | regions[j];
+				members[i].insert(members[i].end(), members[j].begin(), members[j].end());
+				minscale[i] = std::min(minscale[i], minscale[j]);
+				maxscale[i] = std::max(maxscale[i], maxscale[j]);
+				regions.erase(regions.begin()+j);
+				members.erase(members.begin()+j);
+				minscale.erase(minscale.begin()+j);
+				maxscale.erase(maxscale.begin()+j);
+				merged = true;
+			}
+		}
+	}
+
+	// calculate the feature pyramid of each region at its scales, end to end
+	const unsigned int nregions = regions.size();
+	vectorMat pyramid;
+	vectorf scales;
+	vectori levels(1, 0), level;
+	for (unsigned int g = 0; g < nregions; ++g) {
+		vectorMat gpyramid;
+		vectorf gscales;
+		features_->pyramid(im(regions[g]), minscale[g], maxscale[g], gpyramid, gscales);
+		for (unsigned int l = 0; l < gpyramid.size(); ++l) {
+			if (gpyramid[l].empty()) continue;
+			pyramid.push_back(gpyramid[l]);
+			scales.push_back(gscales[l]);
+			level.push_back(l);
+		}
+		levels.push_back(pyramid.size());
+	}
+	if (stats) pyramidStats(pyramid, elapsed(t), *stats);
+
+	// detect over the combined pyramid
+	CandidateSet combined;
+	boost::shared_ptr<DetectionWorkspace> workspace = workspaces_.acquire();
+	detectPyramid(pyramid, scales, levels, combined, *workspace, stats);
+
+	// map the candidates back to the image, keeping those within a region
+	const unsigned int first = candidates.size();
+	for (unsigned int k = 0; k < combined.size(); ++k) {
+		const unsigned int g = std::upper_bound(levels.begin(), levels.end(), combined.scale(k)) - levels.begin() - 1;
+		const Rect box = combined.boundingBox(k) + regions[g].tl();
+		const Point centre(box.x + box.width/2, box.y + box.height/2);
+		const float scale = scales[combined.scale(k)];
+		bool within = false;
+		for (unsigned int i = 0; i < members[g].size() && !within; ++i) within = rois[members[g][i]].contains(centre, scale);
+		if (!within) continue;
+		candidates.push_back(combined, k);
+		candidates.setScale(candidates.size()-1, level[combined.scale(k)]);
+		candidates.translate(candidates.size()-1, regions[g].tl());
+	}
+	if (stats) {
+		stats->candidates = candidates.size() - first;
+		stats->total = elapsed(t);
+		stats_sink_->write(*stats);
+	}
+}
+
+/*! @brief search a batch of images for potential object candidates
+ *
+ * calls detect(const vector<Mat>& images, vector<CandidateSet>& candidates);
+ *
+ * @param images the input color or grayscale images
+ * @param candidates the output detection candidates of each image
+ */
+template<typename T>
+void PartsBasedDetector<T>::detect(const vector<Mat>& images, vector<vectorCandidate>& candidates) const {
+	vector<CandidateSet> sets;
+	detect(images, sets);
+	candidates.resize(images.size());
+	for (unsigned int n = 0; n < images.size(); ++n) {
+		candidates[n].clear();
+		sets[n].toCandidates(candidates[n]);
+	}
+}
+
+/*! @brief search a batch of images for potential object candidates
+ *
+ * The feature pyramids of all of the images are concatenated, so that the
+ * convolution and dynamic programming stages each run as a single parallel
+ * loop over the levels of every image. Small images then occupy all of
+ * the cores rather than the handful that their own pyramid levels would.
+ * The candidates are identical to those of detect() called on each image.
+ * The batch is written to the stats sink, if one is set, as a single
+ * detection, with resampling and feature computation timed together as
+ * features
+ *
+ * @param images the input color or grayscale images
+ * @param candidates the output detection candidates of each image
+ */
+template<typename T>
+void PartsBasedDetector<T>::detect(const vector<Mat>& images, vector<CandidateSet>& candidates) const {
+
+	// calculate the feature pyramids of every image, end to end
+	const double t = (double)getTickCount();
+	DetectionStats statsink;
+	DetectionStats* stats = stats_sink_ ? &statsink : NULL;
+	const unsigned int nimages = images.size();
 	vectorMat pyramid;
-	features_->pyramid(im, pyramid);
+	vectorf scales;
+	vectori levels(1, 0);
+	for (unsigned int n = 0; n < nimages; ++n) {
+		vectorMat impyramid;
+		vectorf imscales;
+		features_->pyramid(images[n], impyramid, imscales);
+		pyramid.insert(pyramid.end(), impyramid.begin(), impyramid.end());
+		scales.insert(scales.end(), imscales.begin(), imscales.end());
+		levels.push_back(pyramid.size());
+	}
+	if (stats) pyramidStats(pyramid, elapsed(t), *stats);
+
+	// detect over the combined pyramid, then split the candidates by image
+	CandidateSet combined;
+	boost::shared_ptr<DetectionWorkspace> workspace = workspaces_.acquire();
+	detectPyramid(pyramid, scales, levels, combined, *workspace, stats);
+	candidates.assign(nimages, CandidateSet());
+	for (unsigned int k = 0; k < combined.size(); ++k) {
+		const unsigned int n = std::upper_bound(levels.begin(), levels.end(), combined.scale(k)) - levels.begin() - 1;
+		candidates[n].push_back(combined, k);
+		candidates[n].setScale(candidates[n].size()-1, combined.scale(k) - levels[n]);
+	}
+	if (stats) {
+		stats->total = elapsed(t);
+		stats_sink_->write(*stats);
+	}
+}
+
+/*! @brief search an image for potential object candidates, without blocking
+ *
+ * The detection runs on the detector's executor (see setExecutor()), and
+ * its result is retrieved through the returned future or the callback.
+ * The detection checks for cancellation (DetectionFuture::cancel())
+ * between the pyramid, convolution, message passing and backtracking
+ * stages. The image is not copied, so must not be modified until the
+ * detection has finished
+ *
+ * @param im the input color or grayscale image
+ * @param depth the image depth image, used for depth consistency and search space pruning
+ * @param callback called on completion, on the executor's thread
+ * @return a future for the detection candidates
+ */
+template<typename T>
+DetectionFuture PartsBasedDetector<T>::detectAsync(const Mat& im, const Mat& depth, const DetectionCallback& callback) const {
+	// submit to a copy, since submit() may block and setExecutor() may replace the executor meanwhile
+	boost::shared_ptr<DetectionExecutor> executor;
+	{
+		boost::mutex::scoped_lock lock(executor_mutex_);
+		if (!executor_) executor_.reset(new DetectionExecutor(DEFAULT_EXECUTOR_THREADS, DEFAULT_EXECUTOR_CAPACITY));
+		executor = executor_;
+	}
+	return executor->submit(boost::bind(&PartsBasedDetector<T>::detectRequest, this, im, depth, _1), callback);
+}
+
+/*! @brief the task run by the executor for detectAsync()
+ *
+ * @param im the input color or grayscale image
+ * @param depth the image depth image
+ * @param request the request, which receives the candidates
+ * @return false if the detection was cancelled, in which case nothing is
+ * written to the stats sink
+ */
+template<typename T>
+bool PartsBasedDetector<T>::detectRequest(const Mat& im, const Mat& depth, DetectionRequest& request) const {
+
+	const double t = (double)getTickCount();
+	DetectionStats statsink;
+	DetectionStats* stats = stats_sink_ ? &statsink : NULL;
+	boost::shared_ptr<DetectionWorkspace> workspace = workspaces_.acquire();
+	vectorMat features;
+	vectorf scales;
+	pyramid(im, features, scales, stats);
+	if (request.cancelled()) return false;
+
+	vector2DMat pdf;
+	convolve(features, pdf, *workspace, stats);
+	features.clear();
+	if (request.cancelled()) return false;
+
+	vectori levels(2, 0);
+	levels[1] = pdf.size();
+	if (!solve(pdf, scales, levels, request.candidates(), &request, Deadline(), NULL, stats)) return false;
+	if (stats) {
+		stats->total = elapsed(t);
+		stats_sink_->write(*stats);
+	}
+	return true;
+}
+
+/*! @brief search a feature pyramid for potential object candidates
+ *
+ * The pyramid may hold the levels of several images end to end, in which
+ * case the top-K detections (see setTopK()) are selected for each image
+ * separately
+ *
+ * @param pyramid the feature pyramid, fine to coarse for each image
+ * @param scales the scale of each level of the pyramid
+ * @param levels the index of the first level of each image, followed by pyramid.size()
+ * @param candidates the output set of detection candidates above the threshold
+ * @param workspace the scratch state of the call
+ * @param stats if not NULL, receives the stats of convolution and of the dynamic program
+ */
+template<typename T>
+void PartsBasedDetector<T>::detectPyramid(const vectorMat& pyramid, const vectorf& scales, const vectori& levels, CandidateSet& candidates,
+		DetectionWorkspace& workspace, DetectionStats* stats) const {
+	TRACE_SPAN("detect/pyramid");
+	vector2DMat pdf;
+	convolve(pyramid, pdf, workspace, stats);
+	solve(pdf, scales, levels, candidates, NULL, Deadline(), NULL, stats);
+}
+
+/*! @brief compute the feature pyramid of an image
+ *
+ * The first stage of detect(). Like detect(), the stages do not modify the
+ * detector, so they may run concurrently on different images
+ *
+ * @param im the input color or grayscale image
+ * @param pyramid the feature pyramid, fine to coarse
+ * @param scales the scale of each level of the pyramid
+ * @param stats if not NULL, receives the durations of resampling and feature computation
+ */
+template<typename T>
+void PartsBasedDetector<T>::pyramid(const Mat& im, vectorMat& pyramid, vectorf& scales, DetectionStats* stats) const {
+	if (!stats) {
+		features_->pyramid(im, pyramid, scales);
+		return;
+	}
+
+	// resample, then compute the features, timing each
+	double t = (double)getTickCount();
+	vectorMat images;
+	features_->images(im, images, scales);
+	stats->resize = elapsed(t);
+	t = (double)getTickCount();
+	const unsigned int nlevels = images.size();
+	pyramid.clear();
+	pyramid.resize(nlevels);
+	#ifdef _OPENMP
+	#pragma omp parallel for
+	#endif
+	for (unsigned int n = 0; n < nlevels; ++n) {
+		TRACE_SPAN_LEVEL("hog/features", n);
+		features_->features(images[n], pyramid[n]);
+	}
+	stats->features = elapsed(t);
+	stats->levels = nlevels;
+	stats->featurebytes = bytes(pyramid);
+}
+
+/*! @brief convolve a feature pyramid with the part filters
+ *
+ * The second stage of detect(). If the model has a cascade, the root filters
+ * are convolved first, and the remaining filters only for the units which
+ * pass the first stage of the cascade
+ *
+ * @param pyramid the feature pyramid
+ * @param pdf the probability density (response) of each filter at each level
+ */
+template<typename T>
+void PartsBasedDetector<T>::convolve(const vectorMat& pyramid, vector2DMat& pdf) const {
+	boost::shared_ptr<DetectionWorkspace> workspace = workspaces_.acquire();
+	convolve(pyramid, pdf, *workspace);
+}
+
+/*! @brief convolve a feature pyramid with the part filters, using the caller's workspace
+ *
+ * @param pyramid the feature pyramid
+ * @param pdf the probability density (response) of each filter at each level
+ * @param workspace the scratch state of the call
+ * @param stats if not NULL, receives the duration of convolution, in total and for each level
+ */
+template<typename T>
+void PartsBasedDetector<T>::convolve(const vectorMat& pyramid, vector2DMat& pdf, DetectionWorkspace& workspace, DetectionStats* stats) const {
 
 	// convolve the feature pyramid with the Part experts
 	// to get probability density for each Part
-	double t = (double)getTickCount();
-	vector2DMat pdf;
-	convolution_engine_->pdf(pyramid, pdf);
-	printf("Convolution time: %f\n", ((double)getTickCount() - t)/getTickFrequency());
+	const double t = (double)getTickCount();
+	IConvolutionWorkspace& engine = workspace.convolution(convolution_engine_);
+	vector2Di mask;
+	if (dp_.cascade()) {
+		// convolve the root filters first, then the remaining filters
+		// only for the units which pass the first stage of the cascade
+		vector2Di alive(pyramid.size(), vectori(parts_.ncomponents(), 1));
+		dp_.filterMask(alive, true, mask);
+		convolveLevels(pyramid, pdf, mask, engine, stats);
+		dp_.prune(pdf, alive);
+		dp_.filterMask(alive, false, mask);
+	}
+	convolveLevels(pyramid, pdf, mask, engine, stats);
+
+	if (stats) {
+		stats->convolution = elapsed(t);
+		countResponses(pdf, *stats);
+	}
+}
+
+/*! @brief convolve a subset of the responses of a feature pyramid
+ *
+ * When stats are collected, the levels are convolved one at a time so
+ * that each can be timed. The filters of each level are still convolved
+ * in parallel
+ *
+ * @param pyramid the feature pyramid
+ * @param pdf the probability density (response) of each filter at each level
+ * @param mask nonzero for each (level, filter) response to compute. An empty mask selects all responses
+ * @param engine the convolution workspace
+ * @param stats if not NULL, the duration of each level is added to its levelconvolution
+ */
+template<typename T>
+void PartsBasedDetector<T>::convolveLevels(const vectorMat& pyramid, vector2DMat& pdf, const vector2Di& mask, IConvolutionWorkspace& engine, DetectionStats* stats) const {
+	if (!stats) {
+		convolution_engine_->pdf(pyramid, pdf, mask, engine);
+		return;
+	}
+
+	const unsigned int nlevels = pyramid.size();
+	pdf.resize(nlevels);
+	stats->levelconvolution.resize(nlevels, 0.0);
+	for (unsigned int n = 0; n < nlevels; ++n) {
+		const double t = (double)getTickCount();
+		vector2DMat level;
+		if (!pdf[n].empty()) level.push_back(pdf[n]);
+		convolution_engine_->pdf(vectorMat(1, pyramid[n]), level, mask.empty() ? vector2Di() : vector2Di(1, mask[n]), engine);
+		pdf[n] = level[0];
+		stats->levelconvolution[n] += elapsed(t);
+	}
+}
+
+/*! @brief find the detection candidates from the filter responses
+ *
+ * The final stage of detect(): message passing, top-K selection and backtracking
+ *
+ * @param pdf the probability density (response) of each filter at each level
+ * @param scales the scale of each level of the pyramid
+ * @param levels the index of the first level of each image, followed by pdf.size()
+ * @param candidates the output set of detection candidates above the threshold
+ * @param request if not NULL, checked for cancellation before backtracking
+ * @param deadline the time after which message passing starts no more units
+ * @param complete if not NULL, set to false if any unit was skipped for the deadline
+ * @param stats if not NULL, receives the durations of each step, the size of the
+ * dynamic program's state and the number of candidates
+ * @return false if the request was cancelled
+ */
+template<typename T>
+bool PartsBasedDetector<T>::solve(vector2DMat& pdf, const vectorf& scales, const vectori& levels, CandidateSet& candidates,
+		const DetectionRequest* request, const Deadline& deadline, bool* complete, DetectionStats* stats) const {
 
 	// use dynamic programming to predict the best detection candidates from the part responses
 	vector4DMat Ix, Iy, Ik;
+	vector3DMat messages;
 	vector2DMat rootv, rooti;
-	t = (double)getTickCount();
-	dp_.min(parts_, pdf, Ix, Iy, Ik, rootv, rooti);
-	printf("DP min time: %f\n", ((double)getTickCount() - t)/getTickFrequency());
+	double t = (double)getTickCount();
+	bool solved;
+	if (dp_.backtrackOnDemand()) {
+		solved = dp_.min(pdf, messages, rootv, rooti, deadline);
+	} else {
+		solved = dp_.min(pdf, Ix, Iy, Ik, rootv, rooti, deadline);
+	}
+	if (complete) *complete = solved;
+	if (stats) {
+		stats->messages = elapsed(t);
+		stats->dpbytes = bytes(messages) + bytes(Ix) + bytes(Iy) + bytes(Ik) + bytes(rootv) + bytes(rooti);
+	}
+	if (request && request->cancelled()) return false;
 
-	// suppress non-maximal candidates
+	// suppress non-maximal candidates, within each image
 	t = (double)getTickCount();
-	//ssp_.nonMaxSuppression(rootv, features_->scales());
-	printf("non-maxima suppression time: %f\n", ((double)getTickCount() - t)/getTickFrequency());
+	//ssp_.nonMaxSuppression(rootv, scales);
+	if (dp_.topK()) {
+		for (unsigned int n = 0; n+1 < levels.size(); ++n) {
+			vector2DMat imrootv(rootv.begin()+levels[n], rootv.begin()+levels[n+1]);
+			dp_.selectTopK(imrootv);
+			std::copy(imrootv.begin(), imrootv.end(), rootv.begin()+levels[n]);
+		}
+	}
+	if (stats) stats->selection = elapsed(t);
 
 	// walk back down the tree to find the part locations
 	t = (double)getTickCount();
-	dp_.argmin(parts_, rootv, rooti, features_->scales(), Ix, Iy, Ik, candidates);
-	printf("DP argmin time: %f\n", ((double)getTickCount() - t)/getTickFrequency());
-
-	if (!depth.empty()) {
-		//ssp_.filterCandidatesByDepth(parts_, candidates, depth, 0.03);
+	const unsigned int first = candidates.size();
+	if (dp_.backtrackOnDemand()) {
+		dp_.argmin(rootv, rooti, scales, messages, candidates);
+	} else {
+		dp_.argmin(rootv, rooti, scales, Ix, Iy, Ik, candidates);
 	}
+	if (stats) {
+		stats->argmin = elapsed(t);
+		stats->candidates = candidates.size() - first;
+	}
+	return true;
+}
 
+/*! @brief set the executor of detectAsync()
+ *
+ * Replaces the default executor (DEFAULT_EXECUTOR_THREADS threads,
+ * DEFAULT_EXECUTOR_CAPACITY waiting requests, blocking when full). Any
+ * existing executor is shut down, cancelling its waiting requests and
+ * rejecting any submission still blocked on it
+ *
+ * @see DetectionExecutor
+ * @param nthreads the number of detections which may run concurrently
+ * @param capacity the number of detections which may wait to run
+ * @param policy what to do with a new request when capacity are waiting
+ */
+template<typename T>
+void PartsBasedDetector<T>::setExecutor(unsigned int nthreads, unsigned int capacity, DropPolicy policy) {
+	boost::shared_ptr<DetectionExecutor> previous;
+	{
+		boost::mutex::scoped_lock lock(executor_mutex_);
+		previous.swap(executor_);
+		executor_.reset(new DetectionExecutor(nthreads, capacity, policy));
+	}
+	if (previous) previous->shutdown();
 }
 
 /*! @brief Distribute the model parameters to the PartsBasedDetector classes
@@ -110,6 +800,12 @@ void PartsBasedDetector<T>::detect(const Mat& im, const Mat& depth, vectorCandid
 template<typename T>
 void PartsBasedDetector<T>::distributeModel(Model& model) {
 
+	// refuse a model whose parameters are inconsistent, before changing anything
+	std::string problem;
+	if (!model.validate(problem)) {
+		CV_Error(CV_StsBadArg, "inconsistent model: " + problem);
+	}
+
 	// the name of the Part detector
 	name_ = model.name();
 
@@ -120,18 +816,29 @@ void PartsBasedDetector<T>::distributeModel(Model& model) {
 	convolution_engine_.reset(new SpatialConvolutionEngine(DataType<T>::type, model.flen()));
 
 	// make sure the filters are of the correct precision for the Feature engine
+	// (filters already in that precision, such as those of a BinaryModel, are used as is)
 	const unsigned int nfilters = model.filters().size();
 	for (unsigned int n = 0; n < nfilters; ++n) {
+		if (model.filters()[n].depth() == DataType<T>::depth) continue;
 		model.filters()[n].convertTo(model.filters()[n], DataType<T>::type);
 	}
-	convolution_engine_->setFilters(model.filters());
+	model_storage_ = model.storage();
+
+	// use the filters as laid out by the ModelCompiler, if they suit the engine
+	if (model.compiledFilters().size() != nfilters || !convolution_engine_->setCompiledFilters(model.compiledFilters())) {
+		convolution_engine_->setFilters(model.filters());
+	}
+	workspaces_.clear();
 
 	// initialize the tree of Parts
 	parts_ = Parts(model.filters(), model.filtersi(), model.def(), model.defi(), model.bias(), model.biasi(),
 			model.anchors(), model.biasid(), model.filterid(), model.defid(), model.parentid());
 
-	// initialize the dynamic program
-	dp_ = DynamicProgram<T>(model.thresh());
+	// initialize the dynamic program, then check the cascade against the new tree
+	dp_.setThreshold(model.thresh());
+	dp_.setCascade(vector2Df(), vector2Di());
+	dp_.compile(parts_);
+	dp_.setCascade(model.cascadeThresh(), model.cascadeOrder());
 
 }
 
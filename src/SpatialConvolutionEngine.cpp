@@ -13,9 +13,21 @@
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include "SpatialConvolutionEngine.hpp"
+#include "Trace.hpp"
 using namespace std;
 using namespace cv;
 
+/*! @class SpatialConvolutionWorkspace
+ *  @brief the filter engines of a SpatialConvolutionEngine
+ *
+ * FilterEngine keeps its row buffers between calls, so each caller needs
+ * its own engines, built from the shared filter planes
+ */
+class SpatialConvolutionWorkspace : public IConvolutionWorkspace {
+public:
+	vector2DFilterEngine filters;
+};
+
 SpatialConvolutionEngine::SpatialConvolutionEngine(int type, unsigned int flen) :
 	type_(type), flen_(flen) {}
 
@@ -39,7 +51,7 @@ SpatialConvolutionEngine::~SpatialConvolutionEngine() {
  * @param pdf the response to return
  * @param stride the SVM weight length
  */
-void SpatialConvolutionEngine::convolve(const Mat& feature, vectorFilterEngine& filter, Mat& pdf, const unsigned int stride) {
+void SpatialConvolutionEngine::convolve(const Mat& feature, vectorFilterEngine& filter, Mat& pdf, const unsigned int stride) const {
 
 	// error checking
 	assert(feature.depth() == type_);
@@ -72,20 +84,53 @@ void SpatialConvolutionEngine::convolve(const Mat& feature, vectorFilterEngine&
  * @param responses the vector of responses (pdfs) to return
  */
 void SpatialConvolutionEngine::pdf(const vectorMat& features, vector2DMat& responses) {
+	pdf(features, responses, vector2Di());
+}
+
+/*! @brief Calculate a subset of the responses of a set of features to a set of filter experts
+ *
+ * @param features the input features (at different scales, and by extension, size)
+ * @param responses the vector of responses (pdfs) to return
+ * @param mask nonzero for each (scale, filter) response to compute. An empty mask selects all responses
+ */
+void SpatialConvolutionEngine::pdf(const vectorMat& features, vector2DMat& responses, const vector2Di& mask) {
+	if (!workspace_) workspace_.reset(createWorkspace());
+	pdf(features, responses, mask, *workspace_);
+}
+
+/*! @brief Calculate a subset of the responses, using the caller's workspace
+ *
+ * The engine is not modified, so this may be called concurrently from any
+ * number of threads, each with its own workspace
+ *
+ * @param features the input features (at different scales, and by extension, size)
+ * @param responses the vector of responses (pdfs) to return
+ * @param mask nonzero for each (scale, filter) response to compute. An empty mask selects all responses
+ * @param workspace a workspace created by createWorkspace()
+ */
+void SpatialConvolutionEngine::pdf(const vectorMat& features, vector2DMat& responses, const vector2Di& mask, IConvolutionWorkspace& workspace) const {
+
+	SpatialConvolutionWorkspace* ws = dynamic_cast<SpatialConvolutionWorkspace*>(&workspace);
+	if (!ws || ws->filters.size() != filters_.size()) {
+		CV_Error(CV_StsBadArg, "workspace was not created by this engine for its current filters");
+	}
 
 	// preallocate the output
+	TRACE_SPAN("conv/pdf");
 	const unsigned int M = features.size();
 	const unsigned int N = filters_.size();
+	const bool masked = !mask.empty();
 	responses.resize(M, vectorMat(N));
-	// iterate
+	// iterate. Each filter's engines are only used by the thread processing it
 #ifdef _OPENMP
-	omp_set_num_threads(8);
 	#pragma omp parallel for
 #endif
 	for (unsigned int n = 0; n < N; ++n) {
 		for (unsigned int m = 0; m < M; ++m) {
+			if (masked && !mask[m][n]) continue;
+			TRACE_SPAN_LEVEL("conv/filter", m);
 			Mat response;
-			convolve(features[m], filters_[n], response, flen_);
+			convolve(features[m], ws->filters[n], response, flen_);
 			responses[m][n] = response;
 		}
 	}
@@ -94,34 +139,80 @@ void SpatialConvolutionEngine::pdf(const vectorMat& features, vector2DMat& respo
 /*! @brief set the filters
  *
  * given a set of filters, split each filter channel into a plane,
- * in preparation for convolution
+ * in preparation for convolution. Workspaces created before this call
+ * must not be used afterwards
  *
  * @param filters the filters
  */
 void SpatialConvolutionEngine::setFilters(const vectorMat& filters) {
+	workspace_.reset();
+	compileFilters(filters, filters_);
+}
+
+/*! @brief split each filter channel into a plane
+ *
+ * @param filters the filters
+ * @param compiled the channels of each filter, as separate planes
+ */
+void SpatialConvolutionEngine::compileFilters(const vectorMat& filters, vector2DMat& compiled) const {
 
 	const unsigned int N = filters.size();
-	filters_.clear();
-	filters_.resize(N);
+	compiled.clear();
+	compiled.resize(N);
+
+	// split each filter into separate channels
+	for (unsigned int n = 0; n < N; ++n) {
+		split(filters[n].reshape(flen_), compiled[n]);
+	}
+}
+
+/*! @brief set the filters, already split into planes
+ *
+ * Workspaces created before this call must not be used afterwards
+ *
+ * @param compiled the channels of each filter, as separate planes
+ * @return false if any filter does not have one plane of the engine's type per channel
+ */
+bool SpatialConvolutionEngine::setCompiledFilters(const vector2DMat& compiled) {
+
+	for (unsigned int n = 0; n < compiled.size(); ++n) {
+		if (compiled[n].size() != flen_) return false;
+		for (unsigned int c = 0; c < flen_; ++c) {
+			if (compiled[n][c].type() != type_ || compiled[n][c].size() != compiled[n][0].size()) return false;
+		}
+	}
+	workspace_.reset();
+	filters_ = compiled;
+	return true;
+}
+
+/*! @brief create the filter engines for the current filters
+ *
+ * @return a new workspace, owned by the caller
+ */
+IConvolutionWorkspace* SpatialConvolutionEngine::createWorkspace(void) const {
+
+	SpatialConvolutionWorkspace* workspace = new SpatialConvolutionWorkspace;
+	const unsigned int N = filters_.size();
+	workspace->filters.resize(N);
 
-	// split each filter into separate channels, and create a filter engine
+	// create a filter engine for each channel of each filter
 	const unsigned int C = flen_;
 	for (unsigned int n = 0; n < N; ++n) {
-		vectorMat filtervec;
 		std::vector<Ptr<FilterEngine> > filter_engines(C);
-		split(filters[n].reshape(C), filtervec);
 
 		// the first N-1 filters have zero-padding
 		for (unsigned int m = 0; m < C-1; ++m) {
 			Ptr<FilterEngine> fe = createLinearFilter(type_, type_,
-					filtervec[m], Point(-1,-1), 0, BORDER_CONSTANT, -1, Scalar(0,0,0,0));
+					filters_[n][m], Point(-1,-1), 0, BORDER_CONSTANT, -1, Scalar(0,0,0,0));
 			filter_engines[m] = fe;
 		}
 
 		// the last filter has one-padding
 		Ptr<FilterEngine> fe = createLinearFilter(type_, type_,
-				filtervec[C-1], Point(-1,-1), 0, BORDER_CONSTANT, -1, Scalar(1,1,1,1));
+				filters_[n][C-1], Point(-1,-1), 0, BORDER_CONSTANT, -1, Scalar(1,1,1,1));
 		filter_engines[C-1] = fe;
-		filters_[n] = filter_engines;
+		workspace->filters[n] = filter_engines;
 	}
+	return workspace;
 }
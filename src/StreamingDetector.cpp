@@ -0,0 +1,238 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    StreamingDetector.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include "StreamingDetector.hpp"
+#include <boost/bind.hpp>
+using namespace cv;
+using namespace std;
+
+/*! @brief create a pipeline around a detector
+ *
+ * @param detector the detector, which must already have a model distributed to it
+ * @param depth the number of frames each queue between the stages may hold,
+ * at least 1
+ * @param policy what to do with a new frame when the pipeline is full
+ */
+template<typename T>
+StreamingDetector<T>::StreamingDetector(const PartsBasedDetector<T>& detector, unsigned int depth, DropPolicy policy) :
+		detector_(detector), policy_(policy), input_(depth), pyramids_(depth), responses_(depth), output_(depth),
+		next_(0), dropped_(0), running_(false) {}
+
+/*! @brief start the stage threads
+ *
+ * After stop(), the queues are reopened empty so that the pipeline can be
+ * started again. start() does nothing if the pipeline is already running
+ */
+template<typename T>
+void StreamingDetector<T>::start(void) {
+	boost::lock_guard<boost::mutex> lock(mutex_);
+	if (running_) return;
+	running_ = true;
+	input_.open();
+	pyramids_.open();
+	responses_.open();
+	output_.open();
+	threads_.reset(new boost::thread_group);
+	threads_->create_thread(boost::bind(&StreamingDetector<T>::pyramidStage, this));
+	threads_->create_thread(boost::bind(&StreamingDetector<T>::convolveStage, this));
+	threads_->create_thread(boost::bind(&StreamingDetector<T>::solveStage, this));
+}
+
+/*! @brief admit no more frames, but finish the frames in flight */
+template<typename T>
+void StreamingDetector<T>::close(void) {
+	input_.close();
+}
+
+/*! @brief discard the frames in flight and join the stage threads */
+template<typename T>
+void StreamingDetector<T>::stop(void) {
+	input_.close();
+	pyramids_.close();
+	responses_.close();
+	output_.close();
+	if (threads_) threads_->join_all();
+	boost::lock_guard<boost::mutex> lock(mutex_);
+	running_ = false;
+}
+
+/*! @brief submit a frame for detection
+ *
+ * @param image the frame. It is not copied, so should not be modified
+ * until its results have been retrieved
+ * @return false if the frame was dropped or the pipeline is closed
+ */
+template<typename T>
+bool StreamingDetector<T>::push(const Mat& image) {
+	FramePtr frame(new Frame), dropped;
+	frame->image = image;
+	{
+		boost::lock_guard<boost::mutex> lock(mutex_);
+		frame->id = next_++;
+	}
+	const unsigned int ndropped = input_.push(frame, policy_, dropped);
+	boost::lock_guard<boost::mutex> lock(mutex_);
+	dropped_ += ndropped;
+	return dropped != frame;
+}
+
+/*! @brief retrieve the results of the next frame, waiting until they are ready
+ *
+ * A frame on which a stage failed is still returned in order, with no
+ * candidates. The error is written to error if it is given, and otherwise
+ * raised once the frame has been removed from the pipeline
+ *
+ * @param id the id of the frame, counting the frames pushed from 0
+ * @param image the frame
+ * @param candidates the detection candidates of the frame
+ * @param error if not NULL, set to the reason the frame failed, or emptied if it succeeded
+ * @return false if the pipeline has been closed and all results retrieved
+ */
+template<typename T>
+bool StreamingDetector<T>::pop(unsigned long& id, Mat& image, CandidateSet& candidates, string* error) {
+	FramePtr frame;
+	if (!output_.pop(frame)) return false;
+	retrieve(frame, id, image, candidates, error);
+	return true;
+}
+
+/*! @brief retrieve the results of the next frame, if they are ready
+ *
+ * @see pop()
+ * @return false if no results are ready
+ */
+template<typename T>
+bool StreamingDetector<T>::tryPop(unsigned long& id, Mat& image, CandidateSet& candidates, string* error) {
+	FramePtr frame;
+	if (!output_.tryPop(frame)) return false;
+	retrieve(frame, id, image, candidates, error);
+	return true;
+}
+
+/*! @brief hand the results of a frame to the consumer, reporting any failure */
+template<typename T>
+void StreamingDetector<T>::retrieve(const FramePtr& frame, unsigned long& id, Mat& image, CandidateSet& candidates, string* error) {
+	id = frame->id;
+	image = frame->image;
+	candidates.swap(frame->candidates);
+	if (error) *error = frame->error;
+	else if (!frame->error.empty()) CV_Error(CV_StsError, "detection failed: " + frame->error);
+}
+
+/*! @brief pass a frame to the next stage, waiting for space */
+template<typename T>
+void StreamingDetector<T>::forward(BoundedQueue<FramePtr>& queue, const FramePtr& frame) {
+	FramePtr dropped;
+	queue.push(frame, DROP_NONE, dropped);
+}
+
+/*! @brief record that a stage failed on a frame, discarding its intermediate results
+ *
+ * An exception must not escape a stage thread, so each stage catches
+ * everything, and later stages pass the failed frame through untouched
+ */
+template<typename T>
+void StreamingDetector<T>::fail(Frame& frame, const string& error) {
+	frame.error = error;
+	frame.pyramid.clear();
+	frame.pdf.clear();
+	frame.candidates.clear();
+}
+
+/*! @brief compute the feature pyramid of each frame */
+template<typename T>
+void StreamingDetector<T>::pyramidStage(void) {
+	FramePtr frame;
+	while (input_.pop(frame)) {
+		try {
+			detector_.pyramid(frame->image, frame->pyramid, frame->scales);
+		} catch (const std::exception& e) {
+			fail(*frame, e.what());
+		} catch (...) {
+			fail(*frame, "unknown exception");
+		}
+		forward(pyramids_, frame);
+	}
+	pyramids_.close();
+}
+
+/*! @brief convolve the feature pyramid of each frame with the part filters */
+template<typename T>
+void StreamingDetector<T>::convolveStage(void) {
+	FramePtr frame;
+	DetectionWorkspace workspace;
+	while (pyramids_.pop(frame)) {
+		if (frame->error.empty()) {
+			try {
+				detector_.convolve(frame->pyramid, frame->pdf, workspace);
+				frame->pyramid.clear();
+			} catch (const std::exception& e) {
+				fail(*frame, e.what());
+			} catch (...) {
+				fail(*frame, "unknown exception");
+			}
+		}
+		forward(responses_, frame);
+	}
+	responses_.close();
+}
+
+/*! @brief find the detection candidates of each frame */
+template<typename T>
+void StreamingDetector<T>::solveStage(void) {
+	FramePtr frame;
+	while (responses_.pop(frame)) {
+		if (frame->error.empty()) {
+			try {
+				vectori levels(2, 0);
+				levels[1] = frame->pdf.size();
+				detector_.solve(frame->pdf, frame->scales, levels, frame->candidates);
+				frame->pdf.clear();
+			} catch (const std::exception& e) {
+				fail(*frame, e.what());
+			} catch (...) {
+				fail(*frame, "unknown exception");
+			}
+		}
+		forward(output_, frame);
+	}
+	output_.close();
+}
+
+// declare all specializations of the template (this must be the last declaration in the file)
+template class StreamingDetector<float>;
+template class StreamingDetector<double>;
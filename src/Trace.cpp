@@ -0,0 +1,174 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    Trace.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+using namespace std;
+
+namespace {
+
+//! a recorded span
+struct TraceEvent {
+	const char* name;
+	int level;
+	int64 begin, end;
+};
+
+//! the spans recorded by one thread
+struct ThreadTrace {
+	unsigned int tid;
+	vector<TraceEvent> events;
+};
+
+//! the buffers are owned by the registry, not the threads, so they outlive thread pools
+void keep(ThreadTrace*) {}
+
+//! the buffers of every thread which has recorded a span
+struct TraceRegistry {
+	boost::mutex mutex;
+	vector<ThreadTrace*> threads;
+	boost::thread_specific_ptr<ThreadTrace> local;
+	TraceRegistry() : local(keep) {}
+	~TraceRegistry() {
+		for (unsigned int n = 0; n < threads.size(); ++n) delete threads[n];
+	}
+	//! the buffer of the calling thread, registering it on first use
+	ThreadTrace& buffer(void) {
+		ThreadTrace* trace = local.get();
+		if (!trace) {
+			trace = new ThreadTrace;
+			boost::mutex::scoped_lock lock(mutex);
+			trace->tid = threads.size() + 1;
+			threads.push_back(trace);
+			local.reset(trace);
+		}
+		return *trace;
+	}
+};
+
+TraceRegistry& registry(void) {
+	static TraceRegistry registry;
+	return registry;
+}
+
+//! write a string as JSON, escaping quotes and backslashes
+void writeString(FILE* file, const char* str) {
+	fputc('"', file);
+	for (; *str; ++str) {
+		if (*str == '"' || *str == '\\') fputc('\\', file);
+		fputc(*str, file);
+	}
+	fputc('"', file);
+}
+
+}
+
+bool Trace::enabled(void) {
+#ifdef WITH_TRACING
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*! @brief record a span into the buffer of the calling thread
+ *
+ * @param name the name of the span
+ * @param level the pyramid level the span worked on, or -1 if it spans levels
+ * @param begin the start of the span, in ticks
+ * @param end the end of the span, in ticks
+ */
+void Trace::record(const char* name, int level, int64 begin, int64 end) {
+	TraceEvent event = {name, level, begin, end};
+	registry().buffer().events.push_back(event);
+}
+
+/*! @brief discard every recorded span
+ *
+ * Must not be called while spans are being recorded
+ */
+void Trace::clear(void) {
+	TraceRegistry& reg = registry();
+	boost::mutex::scoped_lock lock(reg.mutex);
+	for (unsigned int n = 0; n < reg.threads.size(); ++n) reg.threads[n]->events.clear();
+}
+
+/*! @brief write the recorded spans as a Chrome trace-event JSON file
+ *
+ * Each span is a complete ("X") event, with its time in microseconds
+ * since the first recorded span, and the level (if any) as an
+ * argument. Each thread is named in the order it first recorded a span.
+ * Must not be called while spans are being recorded
+ *
+ * @param path the path of the file
+ * @return true if the file was written
+ */
+bool Trace::write(const string& path) {
+	FILE* file = fopen(path.c_str(), "w");
+	if (!file) return false;
+
+	TraceRegistry& reg = registry();
+	boost::mutex::scoped_lock lock(reg.mutex);
+	const double us = 1e6 / cv::getTickFrequency();
+	int64 origin = 0;
+	bool first = true;
+	for (unsigned int t = 0; t < reg.threads.size(); ++t) {
+		const vector<TraceEvent>& events = reg.threads[t]->events;
+		for (unsigned int n = 0; n < events.size(); ++n, first = false) origin = first ? events[n].begin : std::min(origin, events[n].begin);
+	}
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"PartsBasedDetector\"}}");
+	for (unsigned int t = 0; t < reg.threads.size(); ++t) {
+		const ThreadTrace& trace = *reg.threads[t];
+		fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}", trace.tid, trace.tid);
+		for (unsigned int n = 0; n < trace.events.size(); ++n) {
+			const TraceEvent& event = trace.events[n];
+			fprintf(file, ",\n{\"name\":");
+			writeString(file, event.name);
+			fprintf(file, ",\"cat\":\"pbd\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+					trace.tid, (event.begin - origin) * us, (event.end - event.begin) * us);
+			if (event.level >= 0) fprintf(file, ",\"args\":{\"level\":%d}", event.level);
+			fprintf(file, "}");
+		}
+	}
+	fprintf(file, "\n]}\n");
+	return fclose(file) == 0;
+}
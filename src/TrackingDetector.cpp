@@ -0,0 +1,276 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    TrackingDetector.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include "TrackingDetector.hpp"
+#include <algorithm>
+#include "nms.hpp"
+using namespace cv;
+using namespace std;
+
+//! the number of state variables of a track: centre, width, height and velocity of the centre
+static const int NSTATE = 6;
+//! the number of measured variables of a track: centre, width and height
+static const int NMEASURE = 4;
+
+/*! @brief a possible assignment of a detection to a track */
+struct Assignment {
+	float overlap;
+	unsigned int track;
+	unsigned int candidate;
+	Assignment(float _overlap, unsigned int _track, unsigned int _candidate) :
+		overlap(_overlap), track(_track), candidate(_candidate) {}
+	static bool descending(const Assignment& a1, const Assignment& a2) { return a1.overlap > a2.overlap; }
+};
+
+/*! @brief the measurement of a bounding box */
+static Mat measurement(const Rect& box) {
+	Mat z(NMEASURE, 1, CV_32F);
+	z.at<float>(0) = box.x + box.width/2.0f;
+	z.at<float>(1) = box.y + box.height/2.0f;
+	z.at<float>(2) = box.width;
+	z.at<float>(3) = box.height;
+	return z;
+}
+
+/*! @brief the bounding box of a state */
+static Rect boundingBox(const Mat& state) {
+	const float w = std::max(state.at<float>(2), 1.0f);
+	const float h = std::max(state.at<float>(3), 1.0f);
+	return Rect(cvRound(state.at<float>(0) - w/2), cvRound(state.at<float>(1) - h/2), cvRound(w), cvRound(h));
+}
+
+/*! @brief create a constant velocity Kalman filter starting at a bounding box */
+static KalmanFilter createFilter(const Rect& box) {
+	KalmanFilter kf(NSTATE, NMEASURE, 0, CV_32F);
+	setIdentity(kf.transitionMatrix);
+	kf.transitionMatrix.at<float>(0, 4) = 1;
+	kf.transitionMatrix.at<float>(1, 5) = 1;
+	setIdentity(kf.measurementMatrix);
+	setIdentity(kf.processNoiseCov, Scalar::all(1));
+	setIdentity(kf.measurementNoiseCov, Scalar::all(4));
+	// the initial velocity is unknown
+	setIdentity(kf.errorCovPost, Scalar::all(10));
+	kf.errorCovPost.at<float>(4, 4) = 1000;
+	kf.errorCovPost.at<float>(5, 5) = 1000;
+	kf.statePost = Mat::zeros(NSTATE, 1, CV_32F);
+	Mat position = kf.statePost.rowRange(0, NMEASURE);
+	measurement(box).copyTo(position);
+	return kf;
+}
+
+/*! @brief merge regions which intersect, until none do
+ *
+ * Each merged region covers both regions, at the scales of both
+ *
+ * @param rois the regions
+ */
+static void mergeRois(vector<DetectionRoi>& rois) {
+	for (bool merged = true; merged; ) {
+		merged = false;
+		for (unsigned int i = 0; i < rois.size() && !merged; ++i) {
+			for (unsigned int j = i+1; j < rois.size() && !merged; ++j) {
+				if ((rois[i].rect() & rois[j].rect()).area() == 0) continue;
+				rois[i] = DetectionRoi(rois[i].rect() | rois[j].rect(), std::min(rois[i].minscale(), rois[j].minscale()),
+						std::max(rois[i].maxscale(), rois[j].maxscale()));
+				rois.erase(rois.begin()+j);
+				merged = true;
+			}
+		}
+	}
+}
+
+/*! @brief search the next frame of a video for potential object candidates
+ *
+ * Every cadence frames, and whenever there are no tracks, the whole frame
+ * is searched. Otherwise only the predicted regions of the tracks are
+ * searched, each padded by the margin, at scales within the scale factor
+ * of the track's last detection. The candidates are suppressed by their
+ * overlap with each other, and then update the tracks
+ *
+ * @param im the frame
+ * @param candidates the output set of suppressed detection candidates above the threshold
+ */
+template<typename T>
+void TrackingDetector<T>::detect(const Mat& im, CandidateSet& candidates) {
+
+	predict();
+	scanned_ = tracks_.empty() || cadence_ <= 1 || frame_ % cadence_ == 0;
+	if (scanned_) {
+		detector_.detect(im, candidates);
+	} else {
+		vector<DetectionRoi> rois;
+		rois.reserve(tracks_.size());
+		for (unsigned int t = 0; t < tracks_.size(); ++t) {
+			const Rect& box = tracks_[t].box;
+			const Size pad(cvRound(box.width*margin_), cvRound(box.height*margin_));
+			const Rect rect(box.x - pad.width, box.y - pad.height, box.width + 2*pad.width, box.height + 2*pad.height);
+			const float s = scale(tracks_[t]);
+			rois.push_back(DetectionRoi(rect, s / scalefactor_, s * scalefactor_));
+		}
+		mergeRois(rois);
+		detector_.detect(im, rois, candidates);
+	}
+	candidates.nonMaximaSuppression(suppression_, OVERLAP_IOU);
+	assign(candidates);
+	merge();
+	frame_++;
+}
+
+/*! @brief advance each track to the next frame */
+template<typename T>
+void TrackingDetector<T>::predict(void) {
+	for (unsigned int t = 0; t < tracks_.size(); ++t) {
+		tracks_[t].box = boundingBox(filters_[t].predict());
+	}
+}
+
+/*! @brief assign candidates to tracks
+ *
+ * Pairs of tracks and candidates are assigned greedily in descending order
+ * of overlap. Assigned tracks are corrected by their candidate, unassigned
+ * candidates start new tracks, and unassigned tracks which have missed too
+ * many frames are dropped
+ *
+ * @param candidates the candidates of the frame
+ */
+template<typename T>
+void TrackingDetector<T>::assign(const CandidateSet& candidates) {
+
+	const unsigned int ntracks = tracks_.size();
+	const unsigned int ncandidates = candidates.size();
+	vector<Rect> boxes(ncandidates);
+	for (unsigned int k = 0; k < ncandidates; ++k) boxes[k] = candidates.boundingBox(k);
+
+	vector<Assignment> pairs;
+	for (unsigned int t = 0; t < ntracks; ++t) {
+		for (unsigned int k = 0; k < ncandidates; ++k) {
+			const float overlap = boxOverlap(tracks_[t].box, boxes[k]);
+			if (overlap >= overlap_) pairs.push_back(Assignment(overlap, t, k));
+		}
+	}
+	std::stable_sort(pairs.begin(), pairs.end(), Assignment::descending);
+
+	vector<bool> tassigned(ntracks, false), cassigned(ncandidates, false);
+	for (unsigned int i = 0; i < pairs.size(); ++i) {
+		const unsigned int t = pairs[i].track;
+		const unsigned int k = pairs[i].candidate;
+		if (tassigned[t] || cassigned[k]) continue;
+		tassigned[t] = cassigned[k] = true;
+		Track& track = tracks_[t];
+		track.box = boundingBox(filters_[t].correct(measurement(boxes[k])));
+		track.score = candidates.score(k);
+		track.component = candidates.component(k);
+		track.hits++;
+		track.misses = 0;
+	}
+
+	// drop the tracks which have missed too many frames
+	unsigned int kept = 0;
+	for (unsigned int t = 0; t < ntracks; ++t) {
+		if (!tassigned[t] && ++tracks_[t].misses > maxmisses_) continue;
+		if (kept != t) {
+			tracks_[kept] = tracks_[t];
+			filters_[kept] = filters_[t];
+		}
+		kept++;
+	}
+	tracks_.resize(kept);
+	filters_.resize(kept);
+
+	// start a track for each unassigned candidate
+	for (unsigned int k = 0; k < ncandidates; ++k) {
+		if (cassigned[k]) continue;
+		Track track;
+		track.id = nextid_++;
+		track.box = boxes[k];
+		track.score = candidates.score(k);
+		track.component = candidates.component(k);
+		track.hits = 1;
+		track.misses = 0;
+		tracks_.push_back(track);
+		filters_.push_back(createFilter(boxes[k]));
+	}
+}
+
+/*! @brief merge tracks which follow the same object
+ *
+ * Of two tracks which overlap by at least the assignment overlap, the one
+ * with fewer hits (or, for equal hits, the newer) is dropped
+ */
+template<typename T>
+void TrackingDetector<T>::merge(void) {
+	const unsigned int ntracks = tracks_.size();
+	vector<bool> dropped(ntracks, false);
+	for (unsigned int i = 0; i < ntracks; ++i) {
+		for (unsigned int j = i+1; j < ntracks && !dropped[i]; ++j) {
+			if (dropped[j] || boxOverlap(tracks_[i].box, tracks_[j].box) < overlap_) continue;
+			const bool weaker = tracks_[i].hits < tracks_[j].hits || (tracks_[i].hits == tracks_[j].hits && tracks_[i].id > tracks_[j].id);
+			dropped[weaker ? i : j] = true;
+		}
+	}
+	unsigned int kept = 0;
+	for (unsigned int t = 0; t < ntracks; ++t) {
+		if (dropped[t]) continue;
+		if (kept != t) {
+			tracks_[kept] = tracks_[t];
+			filters_[kept] = filters_[t];
+		}
+		kept++;
+	}
+	tracks_.resize(kept);
+	filters_.resize(kept);
+}
+
+/*! @brief the scale of a track
+ *
+ * The scale is the size of a feature cell in image pixels (see DetectionRoi),
+ * estimated from the height of the track's box and of its component
+ *
+ * @param track the track
+ * @return the scale at which the track was last detected
+ */
+template<typename T>
+float TrackingDetector<T>::scale(const Track& track) const {
+	const PartSchedule<T>& schedule = detector_.dp().schedule();
+	const unsigned int c = (track.component >= 0 && (unsigned int)track.component < schedule.ncomponents()) ? track.component : 0;
+	const int height = schedule.empty() ? 1 : std::max(schedule.extent(c).height, 1);
+	return (float)track.box.height / height;
+}
+
+// declare all specializations of the template (this must be the last declaration in the file)
+template class TrackingDetector<float>;
+template class TrackingDetector<double>;
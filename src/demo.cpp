@@ -38,12 +38,14 @@
 
 #include <iostream>
 #include <cstdio>
+#include <cstdlib>
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/filesystem.hpp>
 #include "PartsBasedDetector.hpp"
 #include "Candidate.hpp"
+#include "BinaryModel.hpp"
 #include "FileStorageModel.hpp"
 #include "MatlabIOModel.hpp"
 #include "Visualize.hpp"
@@ -51,6 +53,7 @@
 #include "nms.hpp"
 #include "Rect3.hpp"
 #include "DistanceTransform.hpp"
+#include "Trace.hpp"
 using namespace cv;
 using namespace std;
 
@@ -67,6 +70,8 @@ int main(int argc, char** argv) {
 	string ext = boost::filesystem::path(argv[1]).extension().string();
 	if (ext.compare(".xml") == 0 || ext.compare(".yaml") == 0) {
 		model.reset(new FileStorageModel);
+	} else if (ext.compare(".pbm") == 0) {
+		model.reset(new BinaryModel);
 	} else if (ext.compare(".mat") == 0) {
 		model.reset(new MatlabIOModel);
 	}
@@ -104,6 +109,13 @@ int main(int argc, char** argv) {
 	printf("Detection time: %f\n", ((double)getTickCount() - t)/getTickFrequency());
 	printf("Number of candidates: %ld\n", candidates.size());
 
+	// write the trace of the detection, if requested
+	const char* trace = getenv("PBD_TRACE");
+	if (trace && Trace::enabled()) {
+		if (Trace::write(trace)) printf("Trace written to %s\n", trace);
+		else printf("Could not write the trace to %s\n", trace);
+	}
+
 	// display the best candidates
 	Visualize visualize(model->name());
 	SearchSpacePruning<float> ssp;
@@ -37,14 +37,108 @@
  */
 #include <stdint.h> 
 #include <stdio.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <limits>
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include "nms.hpp"
+#include "Trace.hpp"
 using namespace std;
 using namespace cv;
 
+/*! @brief is any unmasked element of a row segment at least v
+ *
+ * The loop is free of branches so it vectorizes
+ */
+template<typename T>
+static inline bool anyGreaterEqual(const T* src, const uint8_t* mask, const int begin, const int end, const T v) {
+	int any = 0;
+	if (mask) {
+		for (int n = begin; n < end; ++n) any |= (src[n] >= v) & (mask[n] != 0);
+	} else {
+		for (int n = begin; n < end; ++n) any |= (src[n] >= v);
+	}
+	return any != 0;
+}
+
+/*! @brief find the local maxima within one strip of blocks
+ *
+ * @param src the input matrix
+ * @param sz the size of the window
+ * @param m the first row of the strip
+ * @param dst the output mask
+ * @param mask an input mask to skip particular elements (may be empty)
+ */
+template<typename T>
+static void nonMaximaSuppressionStrip_(const Mat& src, const int sz, const int m, Mat& dst, const Mat& mask) {
+
+	const int M = src.rows;
+	const int N = src.cols;
+	const bool masked = !mask.empty();
+	const int mend = min(m+sz+1, M);
+
+	for (int n = 0; n < N; n += sz+1) {
+		const int nend = min(n+sz+1, N);
+
+		// get the maximal candidate within the block
+		T vcmax = 0;
+		Point cc(-1,-1);
+		for (int i = m; i < mend; ++i) {
+			const T* src_ptr = src.ptr<T>(i);
+			const uint8_t* mask_ptr = masked ? mask.ptr<uint8_t>(i) : NULL;
+			for (int j = n; j < nend; ++j) {
+				if (mask_ptr && !mask_ptr[j]) continue;
+				if (cc.x < 0 || src_ptr[j] > vcmax) { vcmax = src_ptr[j]; cc = Point(j,i); }
+			}
+		}
+		if (cc.x < 0) continue;
+
+		// search the neighbours centered around the candidate, excluding the
+		// block whose maxima we already know, for an element at least as large
+		const int in0 = max(cc.y-sz, 0), in1 = min(cc.y+sz+1, M);
+		const int jn0 = max(cc.x-sz, 0), jn1 = min(cc.x+sz+1, N);
+		bool maximal = true;
+		for (int i = in0; i < in1 && maximal; ++i) {
+			const T* src_ptr = src.ptr<T>(i);
+			const uint8_t* mask_ptr = masked ? mask.ptr<uint8_t>(i) : NULL;
+			if (i >= m && i < mend) {
+				maximal = !anyGreaterEqual(src_ptr, mask_ptr, jn0, n, vcmax) && !anyGreaterEqual(src_ptr, mask_ptr, nend, jn1, vcmax);
+			} else {
+				maximal = !anyGreaterEqual(src_ptr, mask_ptr, jn0, jn1, vcmax);
+			}
+		}
+
+		// if the block centre is also the neighbour centre, then it's a local maxima
+		if (maximal) dst.at<uint8_t>(cc.y, cc.x) = 255;
+	}
+}
+
+/*! @brief find the local maxima within one strip of blocks, of any depth */
+static void nonMaximaSuppressionStrip(const Mat& src, const int sz, const int m, Mat& dst, const Mat& mask) {
+	assert(src.channels() == 1);
+	switch (src.depth()) {
+		case CV_8U:  nonMaximaSuppressionStrip_<uint8_t>(src, sz, m, dst, mask); break;
+		case CV_8S:  nonMaximaSuppressionStrip_<int8_t>(src, sz, m, dst, mask);  break;
+		case CV_16U: nonMaximaSuppressionStrip_<uint16_t>(src, sz, m, dst, mask); break;
+		case CV_16S: nonMaximaSuppressionStrip_<int16_t>(src, sz, m, dst, mask); break;
+		case CV_32S: nonMaximaSuppressionStrip_<int32_t>(src, sz, m, dst, mask); break;
+		case CV_32F: nonMaximaSuppressionStrip_<float>(src, sz, m, dst, mask);   break;
+		case CV_64F: nonMaximaSuppressionStrip_<double>(src, sz, m, dst, mask);  break;
+		default: CV_Error(CV_StsUnsupportedFormat, "Unsupported response type"); break;
+	}
+}
+
+/*! @brief raise an error for a depth the strips do not support
+ *
+ * An exception cannot leave an OpenMP parallel region, so the depth is
+ * checked before the strips are dispatched
+ */
+static void checkDepth(const Mat& src) {
+	if (src.depth() < CV_8U || src.depth() > CV_64F) CV_Error(CV_StsUnsupportedFormat, "Unsupported response type");
+}
+
 /*! @brief suppress non-maximal values
  *
  * nonMaximaSuppression produces a mask (dst) such that every non-zero
@@ -81,7 +175,11 @@ using namespace cv;
  * 	random.setTo(0, maxima == 0);
  * \endcode
  *
- * @param src the input image/matrix, of any valid cv type
+ * Blocks are independent, so strips of blocks are processed in parallel.
+ * The comparisons are made directly on the typed data, and the rows of each
+ * neighbourhood are tested without branching so that they vectorize
+ *
+ * @param src the input image/matrix, single channel of any depth
  * @param sz the size of the window
  * @param dst the mask of type CV_8U, where non-zero elements correspond to
  * local maxima of the src
@@ -89,47 +187,415 @@ using namespace cv;
  */
 void nonMaximaSuppression(const Mat& src, const int sz, Mat& dst, const Mat mask) {
 
-	// initialise the block mask and destination
+	// initialise the destination
+	TRACE_SPAN("nms/dense");
 	const unsigned int M = src.rows;
-	const unsigned int N = src.cols;
-	const bool masked = !mask.empty();
-	Mat block = 255*Mat_<uint8_t>::ones(Size(2*sz+1,2*sz+1));
+	const int nstrips = (M + sz) / (sz+1);
+	checkDepth(src);
 	dst = Mat_<uint8_t>::zeros(src.size());
 
-	// iterate over image blocks
-	for (unsigned int m = 0; m < M; m+=sz+1) {
-		for (unsigned int n = 0; n < N; n+=sz+1) {
-			Point  ijmax;
-			double vcmax, vnmax;
-
-			// get the maximal candidate within the block
-			Range ic(m, min(m+sz+1,M));
-			Range jc(n, min(n+sz+1,N));
-			if (masked)
-				minMaxLoc(src(ic,jc), NULL, &vcmax, NULL, &ijmax, mask(ic,jc));
-			else
-				minMaxLoc(src(ic,jc), NULL, &vcmax, NULL, &ijmax, noArray());
-
-			Point cc = ijmax + Point(jc.start,ic.start);
-
-			// search the neighbours centered around the candidate for the true maxima
-			Range in(max(cc.y-sz,0), min((unsigned int)cc.y+sz+1,M));
-			Range jn(max(cc.x-sz,0), min((unsigned int)cc.x+sz+1,N));
-
-			// mask out the block whose maxima we already know
-			Mat_<uint8_t> blockmask;
-			block(Range(0,in.size()), Range(0,jn.size())).copyTo(blockmask);
-			Range iis(ic.start-in.start, min(ic.start-in.start+sz+1, in.size()));
-			Range jis(jc.start-jn.start, min(jc.start-jn.start+sz+1, jn.size()));
-			blockmask(iis, jis) = Mat_<uint8_t>::zeros(Size(jis.size(),iis.size()));
-
-			minMaxLoc(src(in,jn), NULL, &vnmax, NULL, &ijmax, masked ? mask(in,jn).mul(blockmask) : blockmask);
-			//Point cn = ijmax + Point(jn.start, in.start);
-
-			// if the block centre is also the neighbour centre, then it's a local maxima
-			if (vcmax > vnmax) {
-				dst.at<uint8_t>(cc.y, cc.x) = 255;
+	// iterate over strips of image blocks
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+	#endif
+	for (int s = 0; s < nstrips; ++s) {
+		nonMaximaSuppressionStrip(src, sz, s*(sz+1), dst, mask);
+	}
+}
+
+/*! @brief suppress non-maximal values of many matrices at once
+ *
+ * Equivalent to calling nonMaximaSuppression() on each matrix in turn, but
+ * the strips of all the matrices are processed in parallel together. This
+ * keeps every thread busy even when each matrix is small, as with the root
+ * scores of a pyramid
+ *
+ * @param src the input matrices, single channel of any depth
+ * @param sz the size of the window of each matrix
+ * @param dst the masks of type CV_8U, where non-zero elements correspond to
+ * local maxima of the corresponding src
+ * @param mask input masks to skip particular elements (may be empty)
+ */
+void nonMaximaSuppression(const vector<Mat>& src, const vector<int>& sz, vector<Mat>& dst, const vector<Mat>& mask) {
+
+	// enumerate the strips of every matrix
+	TRACE_SPAN("nms/dense");
+	const unsigned int N = src.size();
+	const bool masked = !mask.empty();
+	vector<Point> strips;
+	dst.resize(N);
+	for (unsigned int n = 0; n < N; ++n) {
+		checkDepth(src[n]);
+		dst[n] = Mat_<uint8_t>::zeros(src[n].size());
+		for (int m = 0; m < src[n].rows; m += sz[n]+1) strips.push_back(Point(m, n));
+	}
+
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+	#endif
+	for (unsigned int s = 0; s < strips.size(); ++s) {
+		const int n = strips[s].y;
+		nonMaximaSuppressionStrip(src[n], sz[n], strips[s].x, dst[n], masked ? mask[n] : Mat());
+	}
+}
+
+/*! @brief the overlap between two boxes
+ *
+ * @param r1 the first box
+ * @param r2 the second box
+ * @param criterion the measure of overlap
+ * @return the overlap, in [0,1]
+ */
+float boxOverlap(const Rect& r1, const Rect& r2, const OverlapCriterion criterion) {
+	const float intersection = (r1 & r2).area();
+	if (intersection <= 0) return 0;
+	const float denominator = (criterion == OVERLAP_IOU) ? r1.area() + r2.area() - intersection : min(r1.area(), r2.area());
+	return intersection / denominator;
+}
+
+//! orders a heap of box indices with the highest score at the top
+struct ScoreLess {
+	const vector<float>& scores;
+	ScoreLess(const vector<float>& scores) : scores(scores) {}
+	bool operator()(unsigned int i1, unsigned int i2) const { return scores[i1] < scores[i2]; }
+};
+
+/*! @brief a uniform grid index of boxes
+ *
+ * The grid covers the extent of a set of boxes, with cells the size of
+ * their mean box. Each id inserted is listed in every cell its box covers,
+ * so any two intersecting boxes share at least one cell
+ */
+class BoxGrid {
+private:
+	Rect extent_;
+	int cw_, ch_, gw_, gh_;
+	vector<vector<unsigned int> > cells_;
+	//! the range of cells (x0,y0,x1,y1) each id is listed in
+	vector<int> ranges_;
+	//! ids which have been removed, and are dropped from cells as they are found
+	vector<char> removed_;
+	//! the last query to visit each id, so each is reported once per query
+	vector<unsigned int> visited_;
+	unsigned int query_;
+
+	//! the range of cells covered by a box, clamped to the grid
+	void cells(const Rect& box, int& x0, int& y0, int& x1, int& y1) const {
+		x0 = min(max((box.x - extent_.x) / cw_, 0), gw_-1);
+		y0 = min(max((box.y - extent_.y) / ch_, 0), gh_-1);
+		x1 = min(max((box.x + box.width  - 1 - extent_.x) / cw_, x0), gw_-1);
+		y1 = min(max((box.y + box.height - 1 - extent_.y) / ch_, y0), gh_-1);
+	}
+public:
+	BoxGrid(const vector<Rect>& boxes) : query_(0) {
+		const unsigned int N = boxes.size();
+		double wsum = 0, hsum = 0;
+		extent_ = N ? boxes[0] : Rect();
+		for (unsigned int n = 0; n < N; ++n) {
+			extent_ |= boxes[n];
+			wsum += boxes[n].width;
+			hsum += boxes[n].height;
+		}
+		cw_ = max(1, N ? (int)(wsum / N) : 1);
+		ch_ = max(1, N ? (int)(hsum / N) : 1);
+		gw_ = extent_.width  / cw_ + 1;
+		gh_ = extent_.height / ch_ + 1;
+		cells_.resize(gw_*gh_);
+	}
+
+	/*! @brief list an id in every cell covered by a box
+	 *
+	 * An id may be inserted again with a different box, in which case it is
+	 * listed in the cells covered by either box, and no cell lists it twice
+	 */
+	void insert(unsigned int id, const Rect& box) {
+		if (id >= removed_.size()) {
+			removed_.resize(id+1, 0);
+			visited_.resize(id+1, numeric_limits<unsigned int>::max());
+			ranges_.resize(4*(id+1), -1);
+		}
+		int x0, y0, x1, y1;
+		cells(box, x0, y0, x1, y1);
+		int* range = &ranges_[4*id];
+		for (int y = y0; y <= y1; ++y) {
+			for (int x = x0; x <= x1; ++x) {
+				if (x >= range[0] && x <= range[2] && y >= range[1] && y <= range[3]) continue;
+				cells_[y*gw_+x].push_back(id);
 			}
 		}
+		if (range[0] < 0) {
+			range[0] = x0; range[1] = y0; range[2] = x1; range[3] = y1;
+		} else {
+			// cells outside the union of the two ranges may be listed twice, but are deduplicated by query()
+			range[0] = min(range[0], x0); range[1] = min(range[1], y0);
+			range[2] = max(range[2], x1); range[3] = max(range[3], y1);
+		}
+	}
+
+	//! stop reporting an id
+	void remove(unsigned int id) { removed_[id] = 1; }
+
+	//! the ids listed in any cell covered by a box, each reported once
+	void query(const Rect& box, vector<unsigned int>& ids) {
+		int x0, y0, x1, y1;
+		cells(box, x0, y0, x1, y1);
+		ids.clear();
+		for (int y = y0; y <= y1; ++y) {
+			for (int x = x0; x <= x1; ++x) {
+				vector<unsigned int>& cell = cells_[y*gw_+x];
+				for (unsigned int k = 0; k < cell.size(); ++k) {
+					const unsigned int id = cell[k];
+					if (removed_[id]) { cell[k--] = cell.back(); cell.pop_back(); continue; }
+					if (visited_[id] == query_) continue;
+					visited_[id] = query_;
+					ids.push_back(id);
+				}
+			}
+		}
+		query_++;
+	}
+};
+
+/*! @brief greedily suppress overlapping boxes
+ *
+ * Boxes are visited from the highest score to the lowest, and a box is kept
+ * iff its overlap with every box kept before it is at most overlap. Only as
+ * many boxes as are visited are ordered, by popping from a heap, so asking
+ * for the first K boxes avoids sorting the rest.
+ *
+ * The kept boxes are indexed by a uniform grid with cells the size of the
+ * mean box, so each box is only compared with the kept boxes which share
+ * a cell with it rather than with all of them
+ *
+ * Example:
+ * \code
+ * 	// keep at most 10 boxes, none of which overlap by more than 50%
+ * 	vector<unsigned int> keep;
+ * 	nonMaximaSuppression(boxes, scores, 0.5, keep, OVERLAP_IOU, 10);
+ * \endcode
+ *
+ * @param boxes the boxes
+ * @param scores the score of each box
+ * @param overlap the largest allowable overlap with a kept box [0.0 1.0)
+ * @param keep the indices of the boxes kept, from highest to lowest score
+ * @param criterion the measure of overlap
+ * @param K the maximum number of boxes to keep, or 0 to keep all
+ */
+void nonMaximaSuppression(const vector<Rect>& boxes, const vector<float>& scores, const float overlap,
+		vector<unsigned int>& keep, const OverlapCriterion criterion, const unsigned int K) {
+
+	TRACE_SPAN("nms/boxes");
+	keep.clear();
+	const unsigned int N = boxes.size();
+	if (N == 0) return;
+	assert(scores.size() == N);
+	BoxGrid grid(boxes);
+	vector<unsigned int> neighbours;
+
+	// visit the boxes from highest to lowest score
+	vector<unsigned int> heap(N);
+	for (unsigned int n = 0; n < N; ++n) heap[n] = n;
+	make_heap(heap.begin(), heap.end(), ScoreLess(scores));
+
+	while (!heap.empty() && (K == 0 || keep.size() < K)) {
+		pop_heap(heap.begin(), heap.end(), ScoreLess(scores));
+		const unsigned int i = heap.back();
+		heap.pop_back();
+
+		// compare with the kept boxes which share a cell
+		bool suppressed = false;
+		grid.query(boxes[i], neighbours);
+		for (unsigned int k = 0; k < neighbours.size() && !suppressed; ++k) {
+			suppressed = boxOverlap(boxes[i], boxes[keep[neighbours[k]]], criterion) > overlap;
+		}
+		if (suppressed) continue;
+
+		// keep the box
+		grid.insert(keep.size(), boxes[i]);
+		keep.push_back(i);
+	}
+}
+
+/*! @brief rescore overlapping boxes rather than suppressing them
+ *
+ * Soft-NMS (N. Bodla, B. Singh, R. Chellappa and L. Davis. "Soft-NMS --
+ * Improving Object Detection With One Line of Code," ICCV 2017). Boxes are
+ * selected from the highest score to the lowest, and the score of each box
+ * not yet selected is decayed according to its IoU o with the selected box:
+ *
+ * 	linear:   d = (o > overlap) ? 1-o : 1
+ * 	gaussian: d = exp(-o^2 / sigma)
+ *
+ * Since the detector's scores may be negative, the decay is applied to the
+ * score relative to the lowest input score: s = smin + (s - smin)*d
+ *
+ * Only the unselected boxes which share a grid cell with the selected box
+ * are rescored, and a rescored box is only reordered in the heap once it
+ * reaches the top, so the cost is O(n log n) for a bounded number of
+ * neighbours
+ *
+ * @param boxes the boxes
+ * @param scores the score of each box, rescored in place
+ * @param keep the indices of the boxes whose rescored score is at least
+ * thresh, from highest to lowest rescored score
+ * @param method the decay function
+ * @param overlap the IoU above which boxes are decayed (linear only)
+ * @param sigma the width of the decay (gaussian only)
+ * @param thresh the lowest rescored score to keep
+ */
+void softNonMaximaSuppression(const vector<Rect>& boxes, vector<float>& scores, vector<unsigned int>& keep,
+		const SoftSuppression method, const float overlap, const float sigma, const float thresh) {
+
+	keep.clear();
+	const unsigned int N = boxes.size();
+	if (N == 0) return;
+	assert(scores.size() == N);
+	const float smin = *min_element(scores.begin(), scores.end());
+	BoxGrid grid(boxes);
+	for (unsigned int n = 0; n < N; ++n) grid.insert(n, boxes[n]);
+	vector<unsigned int> neighbours;
+
+	// a heap of (score, index) pairs. Scores only decrease, so each entry is an
+	// upper bound on its box's score, and is only refreshed when it reaches the top
+	vector<pair<float, unsigned int> > heap(N);
+	for (unsigned int n = 0; n < N; ++n) heap[n] = make_pair(scores[n], n);
+	make_heap(heap.begin(), heap.end());
+
+	while (!heap.empty()) {
+		pop_heap(heap.begin(), heap.end());
+		const unsigned int i = heap.back().second;
+		if (heap.back().first != scores[i]) {
+			heap.back().first = scores[i];
+			push_heap(heap.begin(), heap.end());
+			continue;
+		}
+		heap.pop_back();
+		if (scores[i] < thresh) break;
+		grid.remove(i);
+		keep.push_back(i);
+
+		// decay the neighbours which have not been selected
+		grid.query(boxes[i], neighbours);
+		for (unsigned int k = 0; k < neighbours.size(); ++k) {
+			const unsigned int j = neighbours[k];
+			const float o = boxOverlap(boxes[i], boxes[j], OVERLAP_IOU);
+			if (o <= 0) continue;
+			const float d = (method == SOFT_LINEAR) ? ((o > overlap) ? 1-o : 1) : exp(-o*o / sigma);
+			scores[j] = smin + (scores[j] - smin)*d;
+		}
+	}
+}
+
+/*! @brief the weight of each box in a fusion
+ *
+ * The weights are the scores relative to the lowest score, so that they
+ * are positive even if the scores are not
+ *
+ * @param scores the score of each box
+ * @param weights the weight of each box
+ */
+void fusionWeights(const vector<float>& scores, vector<float>& weights) {
+	weights.resize(scores.size());
+	if (scores.empty()) return;
+	const float smin = *min_element(scores.begin(), scores.end());
+	for (unsigned int n = 0; n < scores.size(); ++n) weights[n] = scores[n] - smin + numeric_limits<float>::epsilon();
+}
+
+/*! @brief the weighted mean of a set of boxes
+ *
+ * @param boxes the boxes
+ * @param weights the weight of each box
+ * @return the box whose corners are the weighted mean of the corners of boxes
+ */
+Rect fuseBoxes(const vector<Rect>& boxes, const vector<float>& weights) {
+	double x1 = 0, y1 = 0, x2 = 0, y2 = 0, wsum = 0;
+	for (unsigned int n = 0; n < boxes.size(); ++n) {
+		const double w = weights[n];
+		x1 += w*boxes[n].x;
+		y1 += w*boxes[n].y;
+		x2 += w*(boxes[n].x + boxes[n].width);
+		y2 += w*(boxes[n].y + boxes[n].height);
+		wsum += w;
+	}
+	if (wsum <= 0) return boxes.empty() ? Rect() : boxes[0];
+	return Rect(Point(cvRound(x1/wsum), cvRound(y1/wsum)), Point(cvRound(x2/wsum), cvRound(y2/wsum)));
+}
+
+/*! @brief cluster boxes for weighted box fusion
+ *
+ * Boxes are visited from the highest weight to the lowest, and each joins
+ * the cluster whose fused box it overlaps most, if that IoU exceeds
+ * overlap, or starts a new cluster otherwise. The fused box of a cluster
+ * is the weighted mean of its members (see fuseBoxes()). Clusters are
+ * indexed by a grid, so each box is only compared with nearby clusters
+ *
+ * (R. Solovyev, W. Wang and T. Gabruseva. "Weighted boxes fusion: Ensembling
+ * boxes from different object detection models," Image and Vision Computing, 2021)
+ *
+ * @param boxes the boxes
+ * @param weights the weight of each box (see fusionWeights())
+ * @param overlap the IoU above which a box joins a cluster
+ * @param clusters the indices of the boxes in each cluster, highest weight first
+ * @param fused the fused box of each cluster
+ * @param labels only boxes with the same label are clustered together (may be empty)
+ */
+void clusterBoxes(const vector<Rect>& boxes, const vector<float>& weights, const float overlap,
+		vector<vector<unsigned int> >& clusters, vector<Rect>& fused, const vector<int>& labels) {
+
+	clusters.clear();
+	fused.clear();
+	const unsigned int N = boxes.size();
+	if (N == 0) return;
+	assert(weights.size() == N);
+	const bool labelled = !labels.empty();
+	BoxGrid grid(boxes);
+	vector<unsigned int> neighbours;
+
+	// the running weighted sums of the corners (x1,y1,x2,y2) of each cluster
+	vector<double> corners;
+	vector<double> wsum;
+
+	vector<unsigned int> heap(N);
+	for (unsigned int n = 0; n < N; ++n) heap[n] = n;
+	make_heap(heap.begin(), heap.end(), ScoreLess(weights));
+
+	while (!heap.empty()) {
+		pop_heap(heap.begin(), heap.end(), ScoreLess(weights));
+		const unsigned int i = heap.back();
+		heap.pop_back();
+		const Rect& box = boxes[i];
+
+		// find the best matching cluster
+		int best = -1;
+		float bestoverlap = overlap;
+		grid.query(box, neighbours);
+		for (unsigned int k = 0; k < neighbours.size(); ++k) {
+			const unsigned int c = neighbours[k];
+			if (labelled && labels[clusters[c][0]] != labels[i]) continue;
+			const float o = boxOverlap(box, fused[c], OVERLAP_IOU);
+			if (o > bestoverlap) { best = c; bestoverlap = o; }
+		}
+
+		// start a new cluster or join the best
+		const double w = weights[i];
+		if (best < 0) {
+			best = clusters.size();
+			clusters.push_back(vector<unsigned int>());
+			corners.resize(corners.size()+4, 0);
+			wsum.push_back(0);
+			fused.push_back(box);
+		}
+		double* corner = &corners[4*best];
+		clusters[best].push_back(i);
+		corner[0] += w*box.x;
+		corner[1] += w*box.y;
+		corner[2] += w*(box.x + box.width);
+		corner[3] += w*(box.y + box.height);
+		wsum[best] += w;
+		if (wsum[best] > 0) {
+			fused[best] = Rect(Point(cvRound(corner[0]/wsum[best]), cvRound(corner[1]/wsum[best])),
+					Point(cvRound(corner[2]/wsum[best]), cvRound(corner[3]/wsum[best])));
+		}
+		grid.insert(best, fused[best]);
 	}
 }
@@ -0,0 +1,131 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    SyntheticModel.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef SYNTHETICMODEL_HPP_
+#define SYNTHETICMODEL_HPP_
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <opencv2/core/core.hpp>
+#include "Model.hpp"
+
+/*! @class SyntheticModel
+ *  @brief a model with random weights, in the shape of a trained model
+ *
+ * The cost of detection depends on the shape of a model (the number of
+ * components, parts and mixtures, the size of the filters and the binning
+ * of the features) but not on the values of its weights. A SyntheticModel
+ * has the shape it is given, random filters drawn from a seeded generator,
+ * and the same deformation for every part, so the benchmarks and the
+ * regression tests need no model files and are reproducible. Each part's
+ * parent is part (p-1)/2
+ */
+class SyntheticModel : public Model {
+public:
+	/*! @brief create a model
+	 *
+	 * @param name the name of the model
+	 * @param nparts the number of parts of each component
+	 * @param nmixtures the number of mixtures of each part
+	 * @param fsize the width and height of each filter, in cells
+	 * @param binsize the size of a feature cell, in pixels
+	 * @param interval the number of levels per octave of the feature pyramid
+	 * @param seed the seed of the random filters
+	 */
+	SyntheticModel(const std::string& name, const vectori& nparts, int nmixtures, int fsize,
+			int binsize, int interval, unsigned int seed = 0) {
+		name_      = name;
+		nparts_    = *std::max_element(nparts.begin(), nparts.end());
+		nmixtures_ = nmixtures;
+		nscales_   = interval;
+		binsize_   = binsize;
+		flen_      = 32;
+		norient_   = 18;
+		thresh_    = -std::numeric_limits<float>::infinity();
+
+		cv::RNG rng(seed);
+		const unsigned int ncomponents = nparts.size();
+		filterid_.resize(ncomponents);
+		defid_.resize(ncomponents);
+		biasid_.resize(ncomponents);
+		parentid_.resize(ncomponents);
+		for (unsigned int c = 0; c < ncomponents; ++c) {
+			for (int p = 0; p < nparts[c]; ++p) {
+				parentid_[c].push_back(p == 0 ? -1 : (p-1)/2);
+				filterid_[c].push_back(vectori());
+				defid_[c].push_back(vectori());
+				biasid_[c].push_back(vectori());
+				for (int m = 0; m < nmixtures; ++m) {
+					cv::Mat filter(fsize, fsize*flen_, cv::DataType<float>::type);
+					rng.fill(filter, cv::RNG::NORMAL, cv::Scalar(0), cv::Scalar(0.05));
+					filterid_[c][p].push_back(filtersw_.size());
+					filtersi_.push_back(filtersw_.size());
+					filtersw_.push_back(filter);
+
+					float w[] = {0.01f, 0.0f, 0.01f, 0.0f};
+					defid_[c][p].push_back(defw_.size());
+					defi_.push_back(defw_.size());
+					defw_.push_back(vectorf(w, w+4));
+					anchors_.push_back(cv::Point((p % 2) ? 2 : -2, (p % 3) - 1));
+
+					// one bias per mixture of the parent
+					biasid_[c][p].push_back(biasw_.size());
+					for (int pm = 0; pm < nmixtures; ++pm) {
+						biasi_.push_back(biasw_.size());
+						biasw_.push_back(rng.uniform(-0.1f, 0.1f));
+					}
+				}
+			}
+		}
+	}
+	virtual ~SyntheticModel() {}
+	//! synthetic models are not serialized
+	bool serialize(const std::string&) const { return false; }
+	bool deserialize(const std::string&) { return false; }
+
+	//! a model in the shape of the 68 part face model (13 views, 68 or 39 parts)
+	static SyntheticModel face(unsigned int seed = 0) {
+		const int views[] = {39, 39, 39, 68, 68, 68, 68, 68, 68, 68, 39, 39, 39};
+		return SyntheticModel("face", vectori(views, views+13), 1, 5, 4, 5, seed);
+	}
+	//! a model in the shape of the 26 part person model (one component, 6 mixtures per part)
+	static SyntheticModel person(unsigned int seed = 0) {
+		return SyntheticModel("person", vectori(1, 26), 6, 5, 4, 10, seed);
+	}
+};
+
+#endif /* SYNTHETICMODEL_HPP_ */
@@ -0,0 +1,263 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    Reference.hpp
+ *  Created: Oct 17, 2026
+ */
+
+#ifndef REFERENCE_HPP_
+#define REFERENCE_HPP_
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdint.h>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "nms.hpp"
+
+/*! @class Reference
+ *  @brief direct scalar implementations of the detector's kernels
+ *
+ * Each method computes the same result as an optimized kernel of the
+ * library by the most literal means, with no attempt at speed, so that
+ * the optimized kernels can be checked against them
+ */
+class Reference {
+private:
+	Reference() {}
+public:
+	/*! @brief the HOG features of an image, as HOGFeatures::features
+	 *
+	 * The features of Felzenszwalb et al., computed in three separate passes
+	 * over indexed arrays: the gradient of each pixel (from the color channel
+	 * with the largest gradient) is snapped to one of 18 orientations and
+	 * interpolated into the histograms of the 4 nearest cells; the energy of
+	 * each cell is summed over the contrast-insensitive orientations; and each
+	 * cell is normalized by the energy of the 4 blocks of 2x2 cells around it,
+	 * giving 18 contrast-sensitive, 9 contrast-insensitive and 4 texture
+	 * features and a zero truncation feature
+	 *
+	 * @param im the image, of depth CV_8U, with 1 or 3 channels
+	 * @param sbin the size of a cell, in pixels
+	 * @param feature the features, (cells.height-2) x ((cells.width-2)*32)
+	 */
+	static void hog(const cv::Mat& im, int sbin, cv::Mat_<double>& feature) {
+		const int norient = 18, flen = 32;
+		const float uu[9] = {1.000f, 0.9397f, 0.7660f, 0.5000f, 0.1736f, -0.1736f, -0.5000f, -0.7660f, -0.9397f};
+		const float vv[9] = {0.000f, 0.3420f, 0.6428f, 0.8660f, 0.9848f,  0.9848f,  0.8660f,  0.6428f,  0.3420f};
+		const int bw = (int)std::floor((double)im.cols / sbin + 0.5), bh = (int)std::floor((double)im.rows / sbin + 0.5);
+		const int ow = std::max(bw-2, 0), oh = std::max(bh-2, 0);
+		const int channels = im.channels();
+
+		// the orientation histogram of each cell
+		std::vector<double> hist(bw*bh*norient, 0.0);
+		for (int y = 1; y < bh*sbin-1; ++y) {
+			for (int x = 1; x < bw*sbin-1; ++x) {
+				const int px = std::min(x, im.cols-2), py = std::min(y, im.rows-2);
+				float dx = 0, dy = 0, v = -1;
+				for (int c = channels-1; c >= 0; --c) {
+					const float cdx = (float)im.ptr<uint8_t>(py)[(px+1)*channels+c] - im.ptr<uint8_t>(py)[(px-1)*channels+c];
+					const float cdy = (float)im.ptr<uint8_t>(py+1)[px*channels+c] - im.ptr<uint8_t>(py-1)[px*channels+c];
+					if (cdx*cdx + cdy*cdy > v) { dx = cdx; dy = cdy; v = cdx*cdx + cdy*cdy; }
+				}
+				float best = 0;
+				int orient = 0;
+				for (int o = 0; o < norient/2; ++o) {
+					const float dot = uu[o]*dx + vv[o]*dy;
+					if (dot > best) { best = dot; orient = o; }
+					else if (-dot > best) { best = -dot; orient = o + norient/2; }
+				}
+				const double yp = (y+0.5)/sbin - 0.5, xp = (x+0.5)/sbin - 0.5;
+				const int iy = (int)std::floor(yp), ix = (int)std::floor(xp);
+				const double wy[2] = {1.0-(yp-iy), yp-iy}, wx[2] = {1.0-(xp-ix), xp-ix};
+				for (int i = 0; i < 2; ++i) {
+					for (int j = 0; j < 2; ++j) {
+						if (iy+i < 0 || iy+i >= bh || ix+j < 0 || ix+j >= bw) continue;
+						hist[((iy+i)*bw + ix+j)*norient + orient] += wy[i]*wx[j]*std::sqrt(v);
+					}
+				}
+			}
+		}
+
+		// the energy of each cell
+		std::vector<double> energy(bw*bh, 0.0);
+		for (int n = 0; n < bw*bh; ++n) {
+			for (int o = 0; o < norient/2; ++o) {
+				const double sum = hist[n*norient+o] + hist[n*norient+o+norient/2];
+				energy[n] += sum*sum;
+			}
+		}
+
+		// normalize each interior cell by the 4 blocks around it, then truncate
+		feature = cv::Mat_<double>::zeros(oh, ow*flen);
+		for (int y = 0; y < oh; ++y) {
+			for (int x = 0; x < ow; ++x) {
+				const int corners[4][2] = {{y+1, x+1}, {y, x+1}, {y+1, x}, {y, x}};
+				double norm[4];
+				for (int b = 0; b < 4; ++b) {
+					const int by = corners[b][0], bx = corners[b][1];
+					norm[b] = 1.0 / std::sqrt(energy[by*bw+bx] + energy[by*bw+bx+1] + energy[(by+1)*bw+bx] + energy[(by+1)*bw+bx+1] + 0.0001);
+				}
+				const double* h = &hist[((y+1)*bw + x+1)*norient];
+				double* f = &feature(y, x*flen);
+				double texture[4] = {0, 0, 0, 0};
+				for (int o = 0; o < norient; ++o) {
+					for (int b = 0; b < 4; ++b) {
+						const double t = std::min(h[o]*norm[b], 0.2);
+						f[o] += 0.5*t;
+						texture[b] += t;
+					}
+				}
+				for (int o = 0; o < norient/2; ++o) {
+					for (int b = 0; b < 4; ++b) f[norient+o] += 0.5*std::min((h[o] + h[o+norient/2])*norm[b], 0.2);
+				}
+				for (int b = 0; b < 4; ++b) f[norient+norient/2+b] = 0.2357*texture[b];
+			}
+		}
+	}
+
+	/*! @brief correlate a feature map with a filter, as SpatialConvolutionEngine
+	 *
+	 * The output is the size of the features. The filter is centred on each
+	 * cell, and the features are padded with zeros, except for the last
+	 * channel (the boundary occlusion feature) which is padded with ones
+	 *
+	 * @param features the features, rows x (cols*flen)
+	 * @param filter the filter, fh x (fw*flen)
+	 * @param flen the number of channels per cell
+	 * @param response the response, rows x cols
+	 */
+	static void correlate(const cv::Mat_<float>& features, const cv::Mat_<float>& filter, int flen, cv::Mat_<float>& response) {
+		const int rows = features.rows, cols = features.cols / flen;
+		const int fh = filter.rows, fw = filter.cols / flen;
+		response.create(rows, cols);
+		for (int y = 0; y < rows; ++y) {
+			for (int x = 0; x < cols; ++x) {
+				double sum = 0;
+				for (int i = 0; i < fh; ++i) {
+					for (int j = 0; j < fw; ++j) {
+						const int yy = y + i - fh/2, xx = x + j - fw/2;
+						const bool inside = yy >= 0 && yy < rows && xx >= 0 && xx < cols;
+						for (int k = 0; k < flen; ++k) {
+							const float f = inside ? features(yy, xx*flen+k) : (k == flen-1 ? 1.0f : 0.0f);
+							sum += filter(i, j*flen+k) * f;
+						}
+					}
+				}
+				response(y, x) = sum;
+			}
+		}
+	}
+
+	/*! @brief the deformation score of displacing a part, as the Quadratic penalty
+	 *
+	 * @param a the quadratic coefficient (negative)
+	 * @param b the linear coefficient
+	 * @param d the displacement
+	 */
+	static double penalty(double a, double b, int d) { return a*d*d + b*d; }
+
+	/*! @brief the generalized distance transform, by exhaustive search
+	 *
+	 * out(y,x) = max over (y',x') of in(y',x') + penalty(ax, bx, x+os.x-x') + penalty(ay, by, y+os.y-y')
+	 *
+	 * @param in the input score
+	 * @param ax the quadratic coefficient in x
+	 * @param bx the linear coefficient in x
+	 * @param ay the quadratic coefficient in y
+	 * @param by the linear coefficient in y
+	 * @param os the anchor offset
+	 * @param out the transformed score
+	 */
+	static void distanceTransform(const cv::Mat_<float>& in, double ax, double bx, double ay, double by,
+			const cv::Point& os, cv::Mat_<float>& out) {
+		out.create(in.size());
+		for (int y = 0; y < in.rows; ++y) {
+			for (int x = 0; x < in.cols; ++x) {
+				double best = -std::numeric_limits<double>::infinity();
+				for (int yy = 0; yy < in.rows; ++yy) {
+					for (int xx = 0; xx < in.cols; ++xx) {
+						best = std::max(best, in(yy, xx) + penalty(ax, bx, x+os.x-xx) + penalty(ay, by, y+os.y-yy));
+					}
+				}
+				out(y, x) = best;
+			}
+		}
+	}
+
+	/*! @brief greedy box suppression, by comparing every pair
+	 *
+	 * @param boxes the boxes
+	 * @param scores the score of each box
+	 * @param overlap the IoU above which the lower scoring box is suppressed
+	 * @param keep the indices of the kept boxes, from highest to lowest score
+	 */
+	static void nonMaximaSuppression(const std::vector<cv::Rect>& boxes, const std::vector<float>& scores, float overlap,
+			std::vector<unsigned int>& keep) {
+		std::vector<std::pair<float, unsigned int> > order;
+		for (unsigned int n = 0; n < boxes.size(); ++n) order.push_back(std::make_pair(-scores[n], n));
+		std::sort(order.begin(), order.end());
+		keep.clear();
+		for (unsigned int n = 0; n < order.size(); ++n) {
+			const unsigned int i = order[n].second;
+			bool suppressed = false;
+			for (unsigned int k = 0; k < keep.size() && !suppressed; ++k) {
+				suppressed = boxOverlap(boxes[i], boxes[keep[k]]) > overlap;
+			}
+			if (!suppressed) keep.push_back(i);
+		}
+	}
+
+	/*! @brief the local maxima of a score map, by comparing every neighbour
+	 *
+	 * @param src the score map
+	 * @param sz the half-width of the neighbourhood
+	 * @param dst 255 at each element greater than every other element within sz of it
+	 */
+	static void localMaxima(const cv::Mat_<float>& src, int sz, cv::Mat& dst) {
+		dst = cv::Mat::zeros(src.size(), CV_8U);
+		for (int y = 0; y < src.rows; ++y) {
+			for (int x = 0; x < src.cols; ++x) {
+				bool maximal = true;
+				for (int i = std::max(y-sz, 0); i < std::min(y+sz+1, src.rows) && maximal; ++i) {
+					for (int j = std::max(x-sz, 0); j < std::min(x+sz+1, src.cols) && maximal; ++j) {
+						maximal = (i == y && j == x) || src(i, j) < src(y, x);
+					}
+				}
+				if (maximal) dst.at<uint8_t>(y, x) = 255;
+			}
+		}
+	}
+};
+
+#endif /* REFERENCE_HPP_ */
@@ -0,0 +1,632 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    regression.cpp
+ *  Created: Oct 17, 2026
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <opencv2/core/core.hpp>
+#include "Reference.hpp"
+#include "SyntheticModel.hpp"
+#include "BinaryModel.hpp"
+#include "CandidateSet.hpp"
+#include "DistanceTransform.hpp"
+#include "DynamicProgram.hpp"
+#include "HOGFeatures.hpp"
+#include "IncrementalDetector.hpp"
+#include "Math.hpp"
+#include "PartsBasedDetector.hpp"
+#include "SpatialConvolutionEngine.hpp"
+#include "TrackingDetector.hpp"
+#include "nms.hpp"
+using namespace cv;
+using namespace std;
+
+//! the seed of every random input
+static const unsigned int SEED = 7;
+
+/*! @class Tally
+ *  @brief counts the checks which passed, failed and were skipped
+ */
+class Tally {
+private:
+	unsigned int passed_, failed_, skipped_;
+public:
+	Tally() : passed_(0), failed_(0), skipped_(0) {}
+	//! record a check, printing any failure
+	bool expect(const string& name, bool ok, const string& detail = "") {
+		printf("%s %s%s%s\n", ok ? "PASS" : "FAIL", name.c_str(), detail.empty() ? "" : ": ", detail.c_str());
+		ok ? passed_++ : failed_++;
+		return ok;
+	}
+	//! record a check which could not be run
+	void skip(const string& name, const string& reason) {
+		printf("SKIP %s: %s\n", name.c_str(), reason.c_str());
+		skipped_++;
+	}
+	unsigned int failed(void) const { return failed_; }
+	void report(void) const { printf("\n%u passed, %u failed, %u skipped\n", passed_, failed_, skipped_); }
+};
+
+/*! @brief compare two matrices within a tolerance
+ *
+ * @param tally the tally to record the check in
+ * @param name the name of the check
+ * @param actual the result of the optimized kernel
+ * @param expected the result of the reference
+ * @param tol the largest difference allowed, relative to the largest magnitude of expected (or 1)
+ * @return true if the matrices match
+ */
+static bool expectNear(Tally& tally, const string& name, const Mat& actual, const Mat& expected, double tol) {
+	if (actual.size() != expected.size() || actual.channels() != expected.channels()) {
+		char detail[128];
+		sprintf(detail, "size %dx%d, expected %dx%d", actual.cols, actual.rows, expected.cols, expected.rows);
+		return tally.expect(name, false, detail);
+	}
+	Mat a, e, diff;
+	actual.convertTo(a, CV_64F);
+	expected.convertTo(e, CV_64F);
+	absdiff(a, e, diff);
+	double maxdiff = 0, emin = 0, emax = 0;
+	if (!diff.empty()) {
+		minMaxLoc(diff.reshape(1), NULL, &maxdiff);
+		minMaxLoc(e.reshape(1), &emin, &emax);
+	}
+	const double bound = tol * std::max(1.0, std::max(std::fabs(emin), std::fabs(emax)));
+	char detail[128];
+	sprintf(detail, "max difference %g (tolerance %g)", maxdiff, bound);
+	return tally.expect(name, maxdiff <= bound, maxdiff <= bound ? "" : detail);
+}
+
+/*! @brief compare two sets of candidates
+ *
+ * @param tally the tally to record the check in
+ * @param name the name of the check
+ * @param actual the candidates of the optimized path
+ * @param expected the candidates of the reference path
+ * @param tol the largest difference in score allowed
+ * @return true if the candidates have the same components, scales and parts, and near scores
+ */
+static bool expectSameCandidates(Tally& tally, const string& name, const CandidateSet& actual, const CandidateSet& expected, double tol) {
+	char detail[128];
+	if (actual.size() != expected.size()) {
+		sprintf(detail, "%u candidates, expected %u", actual.size(), expected.size());
+		return tally.expect(name, false, detail);
+	}
+	for (unsigned int k = 0; k < actual.size(); ++k) {
+		bool same = actual.component(k) == expected.component(k) && actual.scale(k) == expected.scale(k) &&
+				actual.nparts(k) == expected.nparts(k) && std::fabs(actual.score(k) - expected.score(k)) <= tol;
+		for (unsigned int p = 0; p < actual.nparts(k) && same; ++p) same = actual.part(k, p) == expected.part(k, p);
+		if (!same) {
+			sprintf(detail, "candidate %u differs (score %g, expected %g)", k, actual.score(k), expected.score(k));
+			return tally.expect(name, false, detail);
+		}
+	}
+	return tally.expect(name, true);
+}
+
+//! a random matrix, normally distributed
+static Mat randomMat(int rows, int cols, int type, double stddev, RNG& rng) {
+	Mat mat(rows, cols, type);
+	rng.fill(mat, RNG::NORMAL, Scalar::all(0), Scalar::all(stddev));
+	return mat;
+}
+
+//! a random color image
+static Mat randomImage(int width, int height, RNG& rng) {
+	Mat im(height, width, CV_8UC3);
+	rng.fill(im, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+	return im;
+}
+
+/*! @brief HOGFeatures against the literal features, for color and grayscale images of each depth
+ *
+ * The sizes are not multiples of the cell size, so the cells overhang the image
+ */
+static void checkFeatures(Tally& tally) {
+	RNG rng(SEED);
+	const int sizes[][3] = {{41, 33, 4}, {38, 50, 8}};
+	for (unsigned int s = 0; s < 2; ++s) {
+		const Mat color = randomImage(sizes[s][0], sizes[s][1], rng);
+		Mat gray(color.size(), CV_8U);
+		rng.fill(gray, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+		HOGFeatures<float> hog(sizes[s][2], 5, 32, 18);
+		for (unsigned int c = 0; c < 2; ++c) {
+			const Mat& im = c ? gray : color;
+			Mat_<double> expected;
+			Reference::hog(im, sizes[s][2], expected);
+			const int depths[] = {CV_8U, CV_16U, CV_32F, CV_64F};
+			const char* dnames[] = {"8u", "16u", "32f", "64f"};
+			for (unsigned int d = 0; d < 4; ++d) {
+				Mat typed, feature;
+				im.convertTo(typed, depths[d]);
+				hog.features(typed, feature);
+				char name[64];
+				sprintf(name, "features/%dx%d/%s/%s", sizes[s][0], sizes[s][1], c ? "gray" : "color", dnames[d]);
+				expectNear(tally, name, feature, expected, 1e-4);
+			}
+		}
+	}
+}
+
+/*! @brief SpatialConvolutionEngine against direct correlation, for odd and even filters */
+static void checkConvolution(Tally& tally) {
+	RNG rng(SEED);
+	const int flen = 32;
+	const Mat features = randomMat(17, 23*flen, CV_32F, 1.0, rng);
+	const int sizes[][2] = {{5, 5}, {3, 7}, {6, 4}};
+	vectorMat filters;
+	for (unsigned int f = 0; f < 3; ++f) filters.push_back(randomMat(sizes[f][0], sizes[f][1]*flen, CV_32F, 0.1, rng));
+
+	SpatialConvolutionEngine engine(CV_32F, flen);
+	engine.setFilters(filters);
+	vector2DMat responses;
+	engine.pdf(vectorMat(1, features), responses);
+	for (unsigned int f = 0; f < filters.size(); ++f) {
+		Mat_<float> expected;
+		Reference::correlate(features, filters[f], flen, expected);
+		char name[64];
+		sprintf(name, "convolution/%dx%d", sizes[f][0], sizes[f][1]);
+		expectNear(tally, name, responses[0][f], expected, 1e-4);
+	}
+}
+
+/*! @brief DistanceTransform against exhaustive search, checking the scores and their argmax */
+static void checkDistanceTransform(Tally& tally) {
+	RNG rng(SEED);
+	const Mat_<float> scores = randomMat(13, 17, CV_32F, 1.0, rng);
+	const double params[][4] = {{-0.05, 0.0, -0.05, 0.0}, {-0.01, -0.02, -0.03, 0.02}, {-0.002, 0.01, -0.004, -0.01}};
+	const Point offsets[] = {Point(0, 0), Point(2, -1), Point(-3, 4)};
+	DistanceTransform<float> dt;
+	for (unsigned int n = 0; n < 3; ++n) {
+		const double* w = params[n];
+		Mat_<float> out, expected;
+		Mat_<int> Ix, Iy;
+		dt.compute(scores, Quadratic(w[0], w[1]), Quadratic(w[2], w[3]), offsets[n], out, Ix, Iy);
+		Reference::distanceTransform(scores, w[0], w[1], w[2], w[3], offsets[n], expected);
+		char name[64];
+		sprintf(name, "dt/%u/scores", n);
+		expectNear(tally, name, out, expected, 1e-4);
+
+		// the argmax must achieve the score (ties may resolve to either location)
+		Mat_<float> achieved(scores.size());
+		for (int y = 0; y < scores.rows; ++y) {
+			for (int x = 0; x < scores.cols; ++x) {
+				const int xx = Ix(y, x), yy = Iy(y, x);
+				const bool inside = xx >= 0 && xx < scores.cols && yy >= 0 && yy < scores.rows;
+				achieved(y, x) = inside ? scores(yy, xx) + Reference::penalty(w[0], w[1], x+offsets[n].x-xx)
+						+ Reference::penalty(w[2], w[3], y+offsets[n].y-yy) : -numeric_limits<float>::infinity();
+			}
+		}
+		sprintf(name, "dt/%u/argmax", n);
+		expectNear(tally, name, achieved, expected, 1e-4);
+	}
+}
+
+/*! @brief the fused Math::reduceMaxAccumulate() against reduceMax() and reducePickIndex() */
+static void checkReduce(Tally& tally) {
+	RNG rng(SEED);
+	const unsigned int K = 5;
+	vectorMat in, Ix, Iy;
+	vector<float> bias;
+	for (unsigned int k = 0; k < K; ++k) {
+		in.push_back(randomMat(11, 13, CV_32F, 1.0, rng));
+		Mat ix(11, 13, CV_32S), iy(11, 13, CV_32S);
+		rng.fill(ix, RNG::UNIFORM, Scalar(0), Scalar(13));
+		rng.fill(iy, RNG::UNIFORM, Scalar(0), Scalar(11));
+		Ix.push_back(ix);
+		Iy.push_back(iy);
+		bias.push_back(rng.uniform(-0.5f, 0.5f));
+	}
+	const Mat base = randomMat(11, 13, CV_32F, 1.0, rng);
+
+	Mat accum = base.clone(), maxi, Ixout, Iyout;
+	Math::reduceMaxAccumulate<float>(in, bias, Ix, Iy, accum, maxi, Ixout, Iyout);
+
+	vectorMat biased(K);
+	for (unsigned int k = 0; k < K; ++k) biased[k] = in[k] + bias[k];
+	Mat maxv, maxiref, Ixref, Iyref;
+	Math::reduceMax<float>(biased, maxv, maxiref);
+	Math::reducePickIndex<int>(Ix, maxiref, Ixref);
+	Math::reducePickIndex<int>(Iy, maxiref, Iyref);
+	expectNear(tally, "reduce/scores", accum, base + maxv, 1e-6);
+	expectNear(tally, "reduce/maxi", maxi, maxiref, 0);
+	expectNear(tally, "reduce/Ix", Ixout, Ixref, 0);
+	expectNear(tally, "reduce/Iy", Iyout, Iyref, 0);
+}
+
+/*! @brief grid-indexed box suppression and blocked local maxima against exhaustive comparison */
+static void checkSuppression(Tally& tally) {
+	RNG rng(SEED);
+	vector<Rect> boxes;
+	vectorf scores;
+	for (unsigned int n = 0; n < 500; ++n) {
+		const int size = rng.uniform(10, 150);
+		boxes.push_back(Rect(rng.uniform(-50, 640), rng.uniform(-50, 480), size, size + rng.uniform(-5, 5)));
+		scores.push_back(rng.uniform(-1.0f, 1.0f));
+	}
+	vector<unsigned int> keep, expected;
+	nonMaximaSuppression(boxes, scores, 0.3f, keep);
+	Reference::nonMaximaSuppression(boxes, scores, 0.3f, expected);
+	tally.expect("nms/boxes", keep == expected);
+
+	const Mat src = randomMat(61, 83, CV_32F, 1.0, rng);
+	for (int sz = 1; sz <= 3; ++sz) {
+		Mat dst, ref;
+		nonMaximaSuppression(src, sz, dst);
+		Reference::localMaxima(src, sz, ref);
+		char name[64];
+		sprintf(name, "nms/dense/%d", sz);
+		expectNear(tally, name, dst != 0, ref, 0);
+	}
+}
+
+/*! @brief backtracking from stored argmax maps against backtracking on demand */
+static void checkBacktracking(Tally& tally) {
+	RNG rng(SEED);
+	SyntheticModel model = SyntheticModel::person(SEED);
+	HOGFeatures<float> features(model.binsize(), model.nscales(), model.flen(), model.norient());
+	SpatialConvolutionEngine engine(CV_32F, model.flen());
+	engine.setFilters(model.filters());
+	Parts parts(model.filters(), model.filtersi(), model.def(), model.defi(), model.bias(), model.biasi(),
+			model.anchors(), model.biasid(), model.filterid(), model.defid(), model.parentid());
+
+	vectorMat pyramid;
+	vectorf scales;
+	features.pyramid(randomImage(128, 96, rng), pyramid, scales);
+	vector2DMat pdf;
+	engine.pdf(pyramid, pdf);
+
+	// stored argmax maps
+	DynamicProgram<float> stored;
+	stored.setThreshold(model.thresh());
+	stored.setTopK(10);
+	stored.compile(parts);
+	vector2DMat pdfs(pdf), rootvs, rootis;
+	vector4DMat Ix, Iy, Ik;
+	stored.min(pdfs, Ix, Iy, Ik, rootvs, rootis);
+
+	// on demand, with a window covering every level
+	DynamicProgram<float> ondemand;
+	ondemand.setThreshold(model.thresh());
+	ondemand.setTopK(10);
+	ondemand.setBacktrackOnDemand(true, 1000);
+	ondemand.compile(parts);
+	vector2DMat pdfo(pdf), rootvo, rootio;
+	vector3DMat messages;
+	ondemand.min(pdfo, messages, rootvo, rootio);
+
+	bool same = rootvs.size() == rootvo.size();
+	for (unsigned int n = 0; n < rootvs.size() && same; ++n) {
+		for (unsigned int c = 0; c < rootvs[n].size(); ++c) same = same && norm(rootvs[n][c], rootvo[n][c], NORM_INF) <= 1e-4;
+	}
+	tally.expect("backtracking/rootv", same);
+
+	stored.selectTopK(rootvs);
+	ondemand.selectTopK(rootvo);
+	CandidateSet expected, actual;
+	stored.argmin(rootvs, rootis, scales, Ix, Iy, Ik, expected);
+	ondemand.argmin(rootvo, rootio, scales, messages, actual);
+	expectSameCandidates(tally, "backtracking/candidates", actual, expected, 1e-4);
+}
+
+/*! @brief the paths through detect() which should all find the same candidates */
+static void checkPipeline(Tally& tally) {
+	RNG rng(SEED);
+	SyntheticModel model = SyntheticModel::person(SEED);
+	PartsBasedDetector<float> pbd;
+	pbd.distributeModel(model);
+	pbd.setTopK(20);
+	const Mat im = randomImage(160, 120, rng);
+
+	CandidateSet expected;
+	pbd.detect(im, expected);
+
+	vector<Mat> images(2, im);
+	vector<CandidateSet> batch;
+	pbd.detect(images, batch);
+	expectSameCandidates(tally, "pipeline/batch/0", batch[0], expected, 1e-4);
+	expectSameCandidates(tally, "pipeline/batch/1", batch[1], expected, 1e-4);
+
+	CandidateSet timed;
+	DetectionStats stats;
+	pbd.detect(im, Mat(), timed, stats);
+	expectSameCandidates(tally, "pipeline/stats", timed, expected, 1e-4);
+
+	// a region covering the image keeps the candidates centred within it
+	CandidateSet roi, inside;
+	pbd.detect(im, vector<DetectionRoi>(1, DetectionRoi(Rect(0, 0, im.cols, im.rows))), roi);
+	for (unsigned int k = 0; k < expected.size(); ++k) {
+		const Rect box = expected.boundingBox(k);
+		if (Rect(0, 0, im.cols, im.rows).contains(Point(box.x + box.width/2, box.y + box.height/2))) inside.push_back(expected, k);
+	}
+	expectSameCandidates(tally, "pipeline/roi", roi, inside, 1e-4);
+}
+
+/*! @brief TrackingDetector over a still sequence, whose tracks should not multiply
+ *
+ * Every full scan finds the same candidates, several per object, so the
+ * tracks must stay within the candidates of one scan and no two tracks may
+ * follow the same object
+ */
+static void checkTracking(Tally& tally) {
+	RNG rng(SEED);
+	SyntheticModel model = SyntheticModel::person(SEED);
+	PartsBasedDetector<float> pbd;
+	pbd.distributeModel(model);
+	pbd.setTopK(20);
+	const Mat im = randomImage(160, 120, rng);
+	CandidateSet scan;
+	pbd.detect(im, scan);
+
+	const float overlap = 0.3f;
+	TrackingDetector<float> tracker(pbd, 4, overlap);
+	unsigned int maxtracks = 0;
+	bool distinct = true;
+	for (unsigned int f = 0; f < 16; ++f) {
+		CandidateSet candidates;
+		tracker.detect(im, candidates);
+		const vector<TrackingDetector<float>::Track>& tracks = tracker.tracks();
+		maxtracks = std::max<unsigned int>(maxtracks, tracks.size());
+		for (unsigned int i = 0; i < tracks.size(); ++i) {
+			for (unsigned int j = i+1; j < tracks.size(); ++j) distinct = distinct && boxOverlap(tracks[i].box, tracks[j].box) < overlap;
+		}
+	}
+	char detail[128];
+	sprintf(detail, "%u tracks, from %u candidates per scan", maxtracks, scan.size());
+	const bool bounded = maxtracks > 0 && maxtracks <= scan.size();
+	tally.expect("tracking/bounded", bounded, bounded ? "" : detail);
+	tally.expect("tracking/distinct", distinct);
+}
+
+/*! @brief the largest difference between two pyramids of matrices, or infinity if their shapes differ */
+static double maxDifference(const vectorMat& a, const vectorMat& b) {
+	if (a.size() != b.size()) return numeric_limits<double>::infinity();
+	double maxdiff = 0;
+	for (unsigned int n = 0; n < a.size(); ++n) {
+		if (a[n].size() != b[n].size() || a[n].type() != b[n].type()) return numeric_limits<double>::infinity();
+		if (!a[n].empty()) maxdiff = std::max(maxdiff, norm(a[n], b[n], NORM_INF));
+	}
+	return maxdiff;
+}
+
+/*! @brief IncrementalDetector against a full pass, after a patch of the frame changes
+ *
+ * The features and filter responses of the recomputed tiles must match those
+ * of the whole frame exactly, and the candidates those of
+ * PartsBasedDetector::detect() within the tolerance of the root scores
+ */
+static void checkIncremental(Tally& tally) {
+	RNG rng(SEED);
+	SyntheticModel model = SyntheticModel::person(SEED);
+	PartsBasedDetector<float> pbd;
+	pbd.distributeModel(model);
+	pbd.setTopK(20);
+	const Mat first = randomImage(320, 240, rng);
+	Mat second = first.clone();
+	Mat patch = second(Rect(24, 16, 32, 24));
+	rng.fill(patch, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+
+	IncrementalDetector<float> incremental(pbd);
+	CandidateSet ignored, actual, expected;
+	incremental.detect(first, ignored);
+	incremental.detect(second, actual);
+	char detail[128];
+	sprintf(detail, "%.0f%% of the tiles recomputed", 100*incremental.dirty());
+	tally.expect("incremental/partial", incremental.dirty() < 1.0, incremental.dirty() < 1.0 ? "" : detail);
+
+	// the features and responses of the whole frame
+	vectorMat features;
+	vectorf scales;
+	pbd.pyramid(second, features, scales);
+	vector2DMat pdf;
+	pbd.convolve(features, pdf);
+	const double fdiff = maxDifference(incremental.features(), features);
+	sprintf(detail, "max difference %g", fdiff);
+	tally.expect("incremental/features", fdiff == 0, fdiff == 0 ? "" : detail);
+	double rdiff = incremental.pdf().size() == pdf.size() ? 0 : numeric_limits<double>::infinity();
+	for (unsigned int n = 0; n < pdf.size() && rdiff == 0; ++n) rdiff = maxDifference(incremental.pdf()[n], pdf[n]);
+	sprintf(detail, "max difference %g", rdiff);
+	tally.expect("incremental/pdf", rdiff == 0, rdiff == 0 ? "" : detail);
+
+	pbd.detect(second, expected);
+	expectSameCandidates(tally, "incremental/candidates", actual, expected, 1e-4);
+}
+
+//! are the filters of two models identical
+static bool sameFilters(Model& a, Model& b) {
+	if (a.filters().size() != b.filters().size()) return false;
+	for (unsigned int n = 0; n < a.filters().size(); ++n) {
+		if (a.filters()[n].size() != b.filters()[n].size() || norm(a.filters()[n], b.filters()[n], NORM_INF) != 0) return false;
+	}
+	return true;
+}
+
+/*! @brief a model written and mapped back by BinaryModel, which should be unchanged
+ *
+ * The filters of a mapped model are also modified in place (as
+ * CascadeCalibration converts them), which must neither fault nor reach
+ * the file
+ */
+static void checkBinaryModel(Tally& tally) {
+	RNG rng(SEED);
+	SyntheticModel model = SyntheticModel::person(SEED);
+	const string path = "regression_model.pbm";
+	BinaryModel binary(CV_32F);
+	static_cast<Model&>(binary) = model;
+	if (!tally.expect("binary/serialize", binary.serialize(path))) return;
+
+	BinaryModel mapped;
+	if (!tally.expect("binary/deserialize", mapped.deserialize(path))) return;
+	tally.expect("binary/filters", sameFilters(mapped, model));
+	tally.expect("binary/tables", mapped.filterid() == model.filterid() && mapped.biasid() == model.biasid() &&
+			mapped.defid() == model.defid() && mapped.parentid() == model.parentid() && mapped.bias() == model.bias() &&
+			mapped.def() == model.def() && mapped.anchors() == model.anchors());
+	tally.expect("binary/primitives", mapped.name() == model.name() && mapped.nscales() == model.nscales() &&
+			mapped.thresh() == model.thresh() && mapped.binsize() == model.binsize() && mapped.flen() == model.flen() &&
+			mapped.norient() == model.norient());
+
+	// the mapped model detects the same candidates
+	PartsBasedDetector<float> expected, actual;
+	expected.distributeModel(model);
+	actual.distributeModel(mapped);
+	const Mat im = randomImage(160, 120, rng);
+	CandidateSet expectedset, actualset;
+	expected.detect(im, expectedset);
+	actual.detect(im, actualset);
+	expectSameCandidates(tally, "binary/detect", actualset, expectedset, 0);
+
+	// writing to the mapped filters copies their pages, leaving the file as it was
+	for (unsigned int n = 0; n < mapped.filters().size(); ++n) mapped.filters()[n] *= 2;
+	BinaryModel remapped;
+	tally.expect("binary/copyonwrite", remapped.deserialize(path) && sameFilters(remapped, model) && !sameFilters(mapped, model));
+	std::remove(path.c_str());
+}
+
+/*! @brief the kernels against the outputs of the Matlab mex files
+ *
+ * The fixtures are written by matlab/regressionFixtures.m. The checks are
+ * skipped if no directory is given, but once one is, any missing fixture
+ * is a failure, so an empty or mistyped directory cannot pass silently
+ *
+ * @param tally the tally to record the checks in
+ * @param dir the directory of the fixtures
+ */
+static void checkFixtures(Tally& tally, const string& dir) {
+
+	if (dir.empty()) {
+		tally.skip("fixtures", "no --fixtures directory");
+		return;
+	}
+
+	// features.cc
+	FileStorage fs;
+	if (fs.open(dir + "/features.yml", FileStorage::READ)) {
+		Mat im, expected, feature;
+		int sbin;
+		fs["image"] >> im;
+		fs["sbin"] >> sbin;
+		fs["features"] >> expected;
+		HOGFeatures<float> hog(sbin, 5, 32, 18);
+		hog.features(im, feature);
+		expectNear(tally, "fixtures/features", feature, expected, 1e-3);
+		fs.release();
+	} else {
+		tally.expect("fixtures/features", false, "no features.yml in " + dir);
+	}
+
+	// fconv.cc ('valid' output, so compare the interior of the response)
+	if (fs.open(dir + "/fconv.yml", FileStorage::READ)) {
+		Mat features, filter, expected;
+		int flen;
+		fs["features"] >> features;
+		fs["filter"] >> filter;
+		fs["flen"] >> flen;
+		fs["response"] >> expected;
+		SpatialConvolutionEngine engine(CV_32F, flen);
+		features.convertTo(features, CV_32F);
+		filter.convertTo(filter, CV_32F);
+		engine.setFilters(vectorMat(1, filter));
+		vector2DMat responses;
+		engine.pdf(vectorMat(1, features), responses);
+		const Rect interior(filter.cols/flen/2, filter.rows/2, expected.cols, expected.rows);
+		expectNear(tally, "fixtures/fconv", responses[0][0](interior), expected, 1e-4);
+		fs.release();
+	} else {
+		tally.expect("fixtures/fconv", false, "no fconv.yml in " + dir);
+	}
+
+	// dt.cc and shiftdt.cc, with the deformation and offsets as passed from Matlab
+	const char* dts[] = {"dt", "shiftdt"};
+	for (unsigned int n = 0; n < 2; ++n) {
+		const string name = string("fixtures/") + dts[n];
+		if (!fs.open(dir + "/" + dts[n] + ".yml", FileStorage::READ)) {
+			tally.expect(name, false, string("no ") + dts[n] + ".yml in " + dir);
+			continue;
+		}
+		Mat scores, w, offset, expected, Ixexpected, Iyexpected;
+		fs["scores"] >> scores;
+		fs["w"] >> w;
+		fs["offset"] >> offset;
+		fs["out"] >> expected;
+		fs["Ix"] >> Ixexpected;
+		fs["Iy"] >> Iyexpected;
+		w.convertTo(w, CV_64F);
+		offset.convertTo(offset, CV_32S);
+		Mat_<float> in, out;
+		scores.convertTo(in, CV_32F);
+		Mat_<int> Ix, Iy;
+		DistanceTransform<float> dt;
+		dt.compute(in, Quadratic(-w.at<double>(0), -w.at<double>(1)), Quadratic(-w.at<double>(2), -w.at<double>(3)),
+				Point(offset.at<int>(0), offset.at<int>(1)), out, Ix, Iy);
+		expectNear(tally, name + "/scores", out, expected, 1e-4);
+		expectNear(tally, name + "/Ix", Ix, Ixexpected, 0);
+		expectNear(tally, name + "/Iy", Iy, Iyexpected, 0);
+		fs.release();
+	}
+}
+
+int main(int argc, char** argv) {
+
+	string fixtures;
+	for (int n = 1; n < argc; ++n) {
+		if (strcmp(argv[n], "--fixtures") == 0 && n+1 < argc) {
+			fixtures = argv[++n];
+		} else {
+			printf("Usage: PartsBasedDetector_regression [--fixtures directory]\n");
+			return -1;
+		}
+	}
+
+	Tally tally;
+	checkFeatures(tally);
+	checkConvolution(tally);
+	checkDistanceTransform(tally);
+	checkReduce(tally);
+	checkSuppression(tally);
+	checkBacktracking(tally);
+	checkPipeline(tally);
+	checkTracking(tally);
+	checkIncremental(tally);
+	checkBinaryModel(tally);
+	checkFixtures(tally, fixtures);
+	tally.report();
+	return tally.failed() ? 1 : 0;
+}